@@ -1,63 +1,148 @@
 /*
  * ILP.c
  *
+ *	All models are created in a single GUROBI environment, which is loaded on first use and kept until the program exits
+ *	(see freeILP). GUROBI doesn't allow models of one environment to be used on several threads at once, and the portfolio
+ *	may call the optimizer on several threads, so every GUROBI call is made under grbLock: a model is built, optimized
+ *	and freed by one thread at a time (solving a Sudoku model takes little next to loading another environment).
+ *
  *  Created on: Feb 17, 2019
  *      Author: Edanz
  */
 
+#define _POSIX_C_SOURCE 200112L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <string.h>
+#include <time.h>
 #include "map.h"
+#include "ILP.h"
+#ifndef NO_GUROBI
+#include <pthread.h>
 #include "gurobi_c.h"
+#endif
 #include "solver.h"
+#include "propagate.h"
+#include "settings.h"
+#include "geometry.h"
+#include "sat.h"
 
-int ILP(int* b, map *m, double* sol, int dim, int blockw, int blockh);
-int hint(int* b, int index, int boardw, int boardh);
+int ILP(int* b, map *m, double* sol, int dim, int blockw, int blockh, double* start, volatile int* stop);
+int hint(int* b, int index, int boardw, int boardh, mapSolver solver, volatile int* stop);
 void fill(int* b, map* m, double* sol);
 void fillCell(int* b, map* m, double* sol, int index);
-int addCellConst(GRBmodel* model ,map* m, int dim, double* ones);
-int addConst(int* b, GRBmodel* model , map* m, int dim, double* ones, int blockw, int blockh, int type);
-int getIndex(int i, int k, int dim, int blockw, int blockh, int type);
+double* startVector(map* m, int* start);
+#ifndef NO_GUROBI
+GRBenv* loadEnv(int* error);
+int readSolution(GRBmodel* model, double* sol, int total);
+int guessBoard(int* b, int* start, int* guess, geometry* g);
+int setStart(GRBmodel* model, double* warm, int total, const char* from);
+int mapStart(int* b, GRBmodel* model, map* m, int blockw, int blockh, double* start);
+int liveStart(int* b, int* start, geometry* g);
+int addConstrs(int* b, GRBmodel* model, map* m, int dim, int blockw, int blockh, int* numConstrs);
 void allOnes(double* ones, int total);
 void fillBinary(char* type,int total);
+int __stdcall stopCallback(CB_ARGS);
+int buildLive(int blockw, int blockh);
+void freeLive(void);
+
+/*
+ * The model kept by liveSolve between calls: a variable for every value of every cell (variable v-1 + i*dim places v in
+ * cell i), and the values on the board fixed by their variables' lower bounds.
+ */
+typedef struct S_liveModel{
+	GRBmodel* model; /*NULL if there is none*/
+	int blockW;
+	int blockH;
+	int* fixed; /*value fixed in every cell (0 if none)*/
+	double* x; /*solution of the last optimization*/
+	int* last; /*board of the last solution found, the MIP start when there is no other (all 0 if none)*/
+} liveModel;
+
+static GRBenv* sharedEnv = NULL; /*the environment of all models, NULL until loaded*/
+static liveModel live = {NULL, 0, 0, NULL, NULL, NULL};
+static pthread_mutex_t grbLock = PTHREAD_MUTEX_INITIALIZER; /*held around every GUROBI call, and while live is used*/
+#endif
+int getIndex(int i, int k, int dim, int blockw, int blockh, int type);
 
 /*
  * Returns whether the board is solvable or not (1/0), and applies a solution on input array b (if apply==1).
+ * Returns -1 if solver failed (see mapSolver), so whether the board is solvable is unknown.
  * ***apply==0 does not promise board will be unchanged, might edit board even if apply flag is turned off**
  *
- * Receives an array representing the board, block dimensions, flag whether to apply a solution if found, and a index cell that
- * denotes a single cell we wish to find a filling for.
+ * Receives an array representing the board, block dimensions, flag whether to apply a solution if found, a index cell that
+ * denotes a single cell we wish to find a filling for, a warm start (a full board close to a solution, or NULL), the
+ * function solving the map's variables and it's stop flag.
  *
  * Assumes that board is in a valid state as supplied, block sizes are valid and cell is a legal index in board.
  *
- * The solution is done by the ILP function (which works with GUROBI).
+ * The solution is done by solver: the ILP function (which works with GUROBI), or the SAT function (sat module).
+ * Both fill the same solution array, so the rest of the work is the same.
+ * With stats on, the time spent building the map and in the solver is printed, to compare the two (ILP also prints the
+ * time it spends building the model apart from the time it spends optimizing).
  * This functions main role is to prime and initialize structures needed for the ILP.
  * To try and save work for the ILP, first assigns all cell which have only a single solution possible.
+ * Then (unless turned off in settings) makes all the deductions of the propagate module, which fills more cells, removes
+ * candidates (so they get no variables in the map) and finds most unsolvable boards without calling the optimizer.
+ * The warm start is handed to the solver through the map, as the variables of it's values (see mapSolver).
  *
  * If apply = 1
  * 		Fills the supplied array with the solution or returns 0 if impossible in current state.
- * If apply is negative, doesn't fill the whole array, but just the first cell with a hint for the cell in -(apply+1) index.
- * (this is used by the hint function and saves us the work of filling the entire array just to get 1 cell)
+ * If apply = 0 and cell is an index in the board, doesn't fill the whole array, but just that cell (cells filled by the
+ * deductions are filled anyway). This is used by the hint function and saves the work of filling the entire array just
+ * to get 1 cell.
  *
  */
-int solveB(int* b, int blockw, int blockh, int apply, int cell){
+int solveB(int* b, int blockw, int blockh, int apply, int cell, int* start, mapSolver solver, volatile int* stop){
 	map* m;
-	int dim = blockw*blockh, total;
-	double *sol;
+	int dim = blockw*blockh, total, res;
+	double *sol, *warm;
+	clock_t begin;
+	bitmask *cands = NULL;
+	propStats stats;
 	if (!fullAuto(b, blockw, blockh)){ /*makes all obvious placements, returns 0 if that leads to an erroneous state*/
 		return 0;
 	}
-	m = createMap(b,blockw,blockh);
+	if (getSettings()->propagate && dim <= MAX_BIT_DIM){
+		assert((cands = (bitmask*) malloc(dim*dim*sizeof(bitmask)))!=NULL && "Memory allocation error");
+		clearPropStats(&stats);
+		total = propagate(b, cands, blockw, blockh, &stats);
+		if (getSettings()->stats){
+			printPropStats(&stats);
+		}
+		if (!total){ /*contradiction*/
+			free(cands);
+			return 0;
+		}
+	}
+	if (stop != NULL && *stop){ /*the deductions might take a while, no need to go on if the answer isn't needed anymore*/
+		free(cands);
+		return -1;
+	}
+	begin = clock();
+	m = createMap(b,cands,blockw,blockh);
+	free(cands);
+	if (getSettings()->stats && m != NULL){
+		printf("optimizer variables: %d (mapped in %.2f ms)\n", m->total, 1000.0*(clock() - begin)/CLOCKS_PER_SEC);
+	}
 	if (m == NULL){
 		return 0;
 	}
 	total = m->total;
 	assert ((sol =(double*) calloc(total,sizeof(double)))!=NULL && "memory allocation error");
-	if (ILP(b,m,sol,dim,blockw,blockh)!=0){
+	warm = (start != NULL) ? startVector(m, start) : NULL;
+	begin = clock();
+	res = solver(b,m,sol,dim,blockw,blockh,warm,stop);
+	if (getSettings()->stats){
+		printf("%s time: %.2f ms\n", (solver == SAT) ? "sat solver" : "optimizer", 1000.0*(clock() - begin)/CLOCKS_PER_SEC);
+	}
+	free(warm);
+	if (res!=0){
 		free(sol);
 		destroyMap(m);
-		return 0;
+		return (res > 0) ? -1 : 0;
 	}
 	if (apply){
 		fill(b,m,sol);
@@ -74,169 +159,487 @@ int solveB(int* b, int blockw, int blockh, int apply, int cell){
 /*
  * Creates the ILP model, runs it and returns the solution in sol array.
  *
- * Receives an array representing the board, an initialized map, array for solution and block dimentions.
+ * Receives an array representing the board, an initialized map, array for solution, block dimentions and the stop flag
+ * (see mapSolver). If there is a stop flag, a callback terminates the optimization once it's set.
  *
  * Uses Auxiliary function to create the constraints in the model.
+ * The model is created in the shared environment (see loadEnv), with the parameters of settings.h.
+ * When built without GUROBI (NO_GUROBI defined), always fails.
  *
  */
-int ILP(int* b, map *m, double* sol, int dim, int blockw, int blockh){
-	int i;
-	double *ones;
-	GRBenv *env = NULL;
+#ifdef NO_GUROBI
+int ILP(int* b, map *m, double* sol, int dim, int blockw, int blockh, double* start, volatile int* stop){
+	(void) b;
+	(void) m;
+	(void) sol;
+	(void) dim;
+	(void) blockw;
+	(void) blockh;
+	(void) start;
+	(void) stop;
+	return SOLVE_FAILED;
+}
+
+/*
+ * Nothing to free without GUROBI.
+ */
+void freeILP(void){
+}
+
+/*
+ * Always fails without GUROBI.
+ */
+int liveSolve(int* b, int blockw, int blockh, int* start, volatile int* stop){
+	(void) b;
+	(void) blockw;
+	(void) blockh;
+	(void) start;
+	(void) stop;
+	return -1;
+}
+#else
+int ILP(int* b, map *m, double* sol, int dim, int blockw, int blockh, double* start, volatile int* stop){
+	GRBenv *env;
 	GRBmodel *model = NULL;
-	int error, optimstatus, total = GetNumVar(m);
+	int error, total = GetNumVar(m), numConstrs = 0;
 	char* type;
-	/* Create environment */
-	error = GRBloadenv(&env, NULL);
-	if (error || env == NULL){
+	clock_t begin;
+	double buildMs = 0;
+	pthread_mutex_lock(&grbLock);
+	if ((env = loadEnv(&error)) == NULL){
+		pthread_mutex_unlock(&grbLock);
 		return error;
 	}
 	/* Create a model with 0 objective function, and |total| #variables*/
+	begin = clock();
 	assert((type = malloc(total*sizeof(char)))!=NULL && "Memory allocation error");
 	fillBinary(type,total);
-	if ((error = GRBsetintparam(env, GRB_INT_PAR_LOGTOCONSOLE, 0)) || (error = GRBnewmodel(env, &model, "suduko", total, NULL, NULL, NULL, type, NULL))){
-		free(type);
-		GRBfreemodel(model);
-		GRBfreeenv(env);
-		return error;
-	}
+	error = GRBnewmodel(env, &model, "suduko", total, NULL, NULL, NULL, type, NULL);
 	free(type);
-	assert((ones = malloc(total*sizeof(double)))!=NULL && "Memory allocation error");
 	/*add constraints*/
-	allOnes(ones, total);
-	if (addCellConst(model,m,dim,ones)){ /*adds all constrains stating that a cell can receive only a single assignment*/
-		free(ones);
-		GRBfreemodel(model);
-		GRBfreeenv(env);
-		return -1;
+	if (!error){
+		error = addConstrs(b, model, m, dim, blockw, blockh, &numConstrs); /*GUROBI error, or -1 if there is no solution*/
+		buildMs = 1000.0*(clock() - begin)/CLOCKS_PER_SEC;
 	}
-	for (i=0; i<3 ; i++){ /*each iteration adds the rows, cols and block constraints*/
-		if (addConst(b,model, m, dim, ones, blockw, blockh, i)){ /*this function returns a non zero value if fails*/
-			free(ones);
-			GRBfreemodel(model);
-			GRBfreeenv(env);
-			return -1;
-		}
+	if (!error && getSettings()->grbStart){
+		error = mapStart(b, model, m, blockw, blockh, start);
+	}
+	if (!error && stop != NULL){
+		error = GRBsetcallbackfunc(model, stopCallback, (void*) stop);
 	}
-	free(ones);
 	/*solve*/
-	error = GRBoptimize(model);
-	if (error){
-		GRBfreemodel(model);
-		GRBfreeenv(env);
-		return error;
+	if (!error){
+		begin = clock();
+		error = GRBoptimize(model);
+		if (getSettings()->stats){
+			printf("optimizer model: %d constraints built in %.2f ms, optimized in %.2f ms\n", numConstrs, buildMs,
+					1000.0*(clock() - begin)/CLOCKS_PER_SEC);
+		}
+	}
+	/*get actual solution*/
+	if (!error){
+		error = readSolution(model, sol, total);
 	}
+	GRBfreemodel(model);
+	pthread_mutex_unlock(&grbLock);
+	return error;
+}
 
-	/*get solution status*/
-	error = GRBgetintattr(model, GRB_INT_ATTR_STATUS, &optimstatus);
-	if (error){
-		GRBfreemodel(model);
-		GRBfreeenv(env);
-		return error;
+/*
+ * Returns the GUROBI environment shared by all models, loading it (and setting it's parameters) on first call.
+ * Loading checks out a license, which costs a lot more than solving a Sudoku model, so it's done once per run. If it
+ * fails, it's not retried: NULL is returned and *error is set to the same error every time. Called with grbLock held.
+ */
+GRBenv* loadEnv(int* error){
+	static int loadError = 0;
+	settings* s = getSettings();
+	clock_t begin = clock();
+	if (sharedEnv == NULL && loadError == 0){
+		loadError = GRBloadenv(&sharedEnv, NULL);
+		if (!loadError && sharedEnv == NULL){
+			loadError = SOLVE_FAILED;
+		}
+		if (!loadError && ((loadError = GRBsetintparam(sharedEnv, GRB_INT_PAR_LOGTOCONSOLE, 0)) ||
+				(loadError = GRBsetintparam(sharedEnv, GRB_INT_PAR_THREADS, s->grbThreads)) ||
+				(loadError = GRBsetintparam(sharedEnv, GRB_INT_PAR_PRESOLVE, s->grbPresolve)) ||
+				(loadError = GRBsetintparam(sharedEnv, GRB_INT_PAR_MIPFOCUS, s->grbFocus)) ||
+				(loadError = GRBsetintparam(sharedEnv, GRB_INT_PAR_SOLUTIONLIMIT, s->grbSolutions)) ||
+				(s->grbTime > 0 && (loadError = GRBsetdblparam(sharedEnv, GRB_DBL_PAR_TIMELIMIT, (double) s->grbTime))))){
+			GRBfreeenv(sharedEnv);
+			sharedEnv = NULL;
+		}
+		if (s->stats){
+			printf("optimizer environment: %s in %.2f ms\n", loadError ? "failed" : "loaded", 1000.0*(clock() - begin)/CLOCKS_PER_SEC);
+		}
 	}
+	*error = loadError;
+	return sharedEnv;
+}
 
-	if (optimstatus!=2){
-		GRBfreemodel(model);
-		GRBfreeenv(env);
+/*
+ * Reads the solution of an optimized model (of total variables) into sol.
+ * Returns 0 if a solution was found, -1 if the model is infeasible, SOLVE_STOPPED if it was stopped by the stop flag and
+ * SOLVE_FAILED if it hit some other limit (such as the time limit) before finding either, or a GUROBI error.
+ */
+int readSolution(GRBmodel* model, double* sol, int total){
+	int error, status, count;
+	if ((error = GRBgetintattr(model, GRB_INT_ATTR_STATUS, &status)) || (error = GRBgetintattr(model, GRB_INT_ATTR_SOLCOUNT, &count))){
+		return error;
+	}
+	if (count > 0){ /*stopping at the solution limit is a success too, not only GRB_OPTIMAL*/
+		return GRBgetdblattrarray(model, GRB_DBL_ATTR_X, 0, total, sol);
+	}
+	if (status == GRB_INFEASIBLE || status == GRB_INF_OR_UNBD){
 		return -1;
 	}
+	return (status == GRB_INTERRUPTED) ? SOLVE_STOPPED : SOLVE_FAILED;
+}
 
-	/*get actual solution*/
-	error = GRBgetdblattrarray(model, GRB_DBL_ATTR_X, 0, total, sol);
+/*
+ * Frees the shared GUROBI environment, if it was loaded (see header).
+ */
+void freeILP(void){
+	pthread_mutex_lock(&grbLock);
+	freeLive();
+	GRBfreeenv(sharedEnv);
+	sharedEnv = NULL;
+	pthread_mutex_unlock(&grbLock);
+}
+
+/*
+ * Solves board b with the model kept between calls (see header). Returns 1 if b is solvable and fills it with a solution,
+ * 0 if it has no solution, or -1 if GUROBI failed or was stopped.
+ *
+ * Only the cells whose value changed since the last call change the model: the lower bound of the variable of the old
+ * value goes back to 0, and the one of the new value is set to 1. The model is built again only for a board of
+ * different block sizes.
+ * The MIP start is made of start, or of the last solution found if start is NULL (see liveStart).
+ */
+int liveSolve(int* b, int blockw, int blockh, int* start, volatile int* stop){
+	int dim = blockw*blockh, size = dim*dim, i, changed = 0, error = 0, res = -1;
+	clock_t begin = clock();
+	pthread_mutex_lock(&grbLock);
+	if (live.model == NULL || live.blockW != blockw || live.blockH != blockh){
+		freeLive();
+		error = buildLive(blockw, blockh);
+	}
+	for (i = 0 ; i < size && !error ; i++){
+		if (b[i] == live.fixed[i]){
+			continue;
+		}
+		if (live.fixed[i] != 0){
+			error = GRBsetdblattrelement(live.model, GRB_DBL_ATTR_LB, i*dim + live.fixed[i] - 1, 0.0);
+		}
+		if (!error && b[i] != 0){
+			error = GRBsetdblattrelement(live.model, GRB_DBL_ATTR_LB, i*dim + b[i] - 1, 1.0);
+		}
+		live.fixed[i] = b[i];
+		changed++;
+	}
+	if (!error && getSettings()->grbStart){
+		error = liveStart(b, start, getGeometry(blockw, blockh));
+	}
+	if (!error){
+		error = (stop != NULL) ? GRBsetcallbackfunc(live.model, stopCallback, (void*) stop) : GRBsetcallbackfunc(live.model, NULL, NULL);
+	}
+	if (!error){
+		error = GRBoptimize(live.model);
+	}
+	if (!error){
+		error = readSolution(live.model, live.x, size*dim);
+	}
+	if (getSettings()->stats){
+		printf("optimizer live model: %d cells changed, solved in %.2f ms\n", changed, 1000.0*(clock() - begin)/CLOCKS_PER_SEC);
+	}
+	if (error < 0){
+		res = 0;
+	}
+	else if (!error){
+		for (i = 0 ; i < size*dim ; i++){
+			if (live.x[i] > 0.5){
+				b[i/dim] = i%dim + 1;
+			}
+		}
+		memcpy(live.last, b, size*sizeof(int));
+		res = 1;
+	}
+	else if (error != SOLVE_STOPPED && error != SOLVE_FAILED){ /*a GUROBI error, the model might be left half changed*/
+		freeLive();
+	}
+	pthread_mutex_unlock(&grbLock);
+	return res;
+}
+
+/*
+ * Builds the model kept by liveSolve for boards of the given block sizes, with no value fixed.
+ * Every cell gets a single value, and every value appears once in every row, column and block.
+ * Returns 0 on success, or a GUROBI error (leaving no model). Called with grbLock held.
+ */
+int buildLive(int blockw, int blockh){
+	geometry* g = getGeometry(blockw, blockh);
+	int dim = g->dim, size = g->size, total = size*dim, i, k, u, v, nnz = 0, error, *beg, *ind;
+	double* ones;
+	char *type, *sense;
+	GRBenv* env;
+	if ((env = loadEnv(&error)) == NULL){
+		return error;
+	}
+	assert((type = (char*) malloc(total*sizeof(char)))!=NULL && "Memory allocation error");
+	fillBinary(type, total);
+	error = GRBnewmodel(env, &live.model, "suduko", total, NULL, NULL, NULL, type, NULL);
+	free(type);
 	if (error){
-		GRBfreemodel(model);
-		GRBfreeenv(env);
+		GRBfreemodel(live.model);
+		live.model = NULL;
 		return error;
 	}
+	assert((beg = (int*) malloc((4*size + 4*total)*sizeof(int)))!=NULL && "Memory allocation error");
+	ind = beg + 4*size;
+	assert((ones = (double*) malloc(4*total*sizeof(double)))!=NULL && "Memory allocation error");
+	assert((sense = (char*) malloc(4*size*sizeof(char)))!=NULL && "Memory allocation error");
+	allOnes(ones, 4*total);
+	memset(sense, GRB_EQUAL, 4*size);
+	for (i = 0 ; i < size ; i++){ /*a cell can receive only a single assignment*/
+		beg[i] = nnz;
+		for (v = 0 ; v < dim ; v++){
+			ind[nnz] = i*dim + v;
+			nnz++;
+		}
+	}
+	for (u = 0 ; u < 3*dim ; u++){ /*rows, cols and blocks*/
+		for (v = 0 ; v < dim ; v++){
+			beg[size + u*dim + v] = nnz;
+			for (k = 0 ; k < dim ; k++){
+				ind[nnz] = g->units[u*dim + k]*dim + v;
+				nnz++;
+			}
+		}
+	}
+	error = GRBaddconstrs(live.model, 4*size, nnz, beg, ind, ones, sense, ones, NULL);
+	free(beg);
+	free(ones);
+	free(sense);
+	if (error){
+		GRBfreemodel(live.model);
+		live.model = NULL;
+		return error;
+	}
+	live.blockW = blockw;
+	live.blockH = blockh;
+	assert((live.fixed = (int*) calloc(2*size, sizeof(int)))!=NULL && "Memory allocation error"); /*fixed and last*/
+	live.last = live.fixed + size;
+	assert((live.x = (double*) malloc(total*sizeof(double)))!=NULL && "Memory allocation error");
+	return 0;
+}
 
-	/* Free model */
-	GRBfreemodel(model);
+/*
+ * Frees the model kept by liveSolve, if there is one. Called with grbLock held.
+ */
+void freeLive(void){
+	GRBfreemodel(live.model);
+	live.model = NULL;
+	free(live.fixed);
+	live.fixed = NULL;
+	live.last = NULL;
+	free(live.x);
+	live.x = NULL;
+}
 
-	/* Free environment */
-	GRBfreeenv(env);
-	return 0;
+/*
+ * Fills guess with a board to start the optimizer from: the values of b, then the values of start (if not NULL) that
+ * don't clash with the values already in guess, then a greedy fill: every cell still empty gets the smallest value
+ * valid in it. No value of guess clashes with another, but a cell with no valid value left stays empty.
+ * Returns the number of cells left empty.
+ */
+int guessBoard(int* b, int* start, int* guess, geometry* g){
+	int i, v, empty = 0;
+	memcpy(guess, b, g->size*sizeof(int));
+	for (i = 0 ; start != NULL && i < g->size ; i++){
+		if (guess[i] == 0 && start[i] > 0 && isValidAt(guess, g, i, start[i])){
+			guess[i] = start[i];
+		}
+	}
+	for (i = 0 ; i < g->size ; i++){
+		for (v = 1 ; guess[i] == 0 && v <= g->dim ; v++){
+			if (isValidAt(guess, g, i, v)){
+				guess[i] = v;
+			}
+		}
+		empty += (guess[i] == 0);
+	}
+	return empty;
 }
 
 /*
- * Adds all constraints to the model that state we can only assign one value per cell.
+ * Sets the MIP start of the model's total variables to warm (taken from from, printed with the stats). Variables that
+ * are negative in warm are left undefined, GUROBI tries to complete them itself.
+ * With the default solution limit of 1 the optimization ends at the first solution, so comparing the optimize time of
+ * the stats with SUDOKU_GRB_START on and off measures how much sooner the start gets there.
+ * Changes warm. Returns 0 on success, or a GUROBI error.
  */
-int addCellConst(GRBmodel* model ,map* m, int dim, double* ones){
-	int i, j, *cind, NumCells = dim*dim, num, error, startInd;
-	assert((cind = (int*) calloc(dim,sizeof(int)))!=NULL);
-	for (i = 0; i < NumCells ; i++){
-		num = GetNumCell(m, i); /*number of variables in play from this cell*/
-		if (num==0){
-			continue;
+int setStart(GRBmodel* model, double* warm, int total, const char* from){
+	int i, set = 0;
+	for (i = 0 ; i < total ; i++){
+		if (warm[i] < 0){
+			warm[i] = GRB_UNDEFINED;
 		}
-		startInd = GetFirstVar(m,i);
-		for(j = 0; j < num; j++) {
-			cind[j] = startInd + j; /*build array of all indexes for this cell, the coefficients array is always just filled with 1's*/
+		else{
+			set++;
 		}
-		error = GRBaddconstr(model, num, cind, ones, GRB_EQUAL, 1.0, NULL);
-		if (error){
-			free(cind);
-			return error;
+	}
+	if (getSettings()->stats){
+		printf("optimizer start: %d of %d variables set (%s)\n", set, total, from);
+	}
+	return GRBsetdblattrarray(model, GRB_DBL_ATTR_START, 0, total, warm);
+}
+
+/*
+ * Sets the MIP start of a model built on map m: start (the variables of the warm start given to solveB) if there is
+ * one, otherwise a greedy fill of b (see guessBoard). Returns 0 on success, or a GUROBI error.
+ */
+int mapStart(int* b, GRBmodel* model, map* m, int blockw, int blockh, double* start){
+	geometry* g = getGeometry(blockw, blockh);
+	int error, *guess;
+	double* warm;
+	if (start != NULL){
+		assert((warm = (double*) malloc(GetNumVar(m)*sizeof(double)))!=NULL && "Memory allocation error");
+		memcpy(warm, start, GetNumVar(m)*sizeof(double));
+	}
+	else{
+		assert((guess = (int*) malloc(g->size*sizeof(int)))!=NULL && "Memory allocation error");
+		guessBoard(b, NULL, guess, g);
+		warm = startVector(m, guess);
+		free(guess);
+	}
+	error = setStart(model, warm, GetNumVar(m), (start != NULL) ? "warm start" : "greedy fill");
+	free(warm);
+	return error;
+}
+
+/*
+ * Sets the MIP start of the live model for board b: start, or the last solution found if start is NULL, repaired and
+ * completed by guessBoard. The variables of cells guessBoard leaves empty are undefined.
+ * Returns 0 on success, or a GUROBI error. Called with grbLock held.
+ */
+int liveStart(int* b, int* start, geometry* g){
+	int dim = g->dim, i, v, error, *guess;
+	double* warm;
+	const char* from = (start != NULL) ? "warm start" : (live.last[0] != 0) ? "last solution" : "greedy fill";
+	if (start == NULL){ /*live.last is all 0 until a solution is found, which only leaves the greedy fill*/
+		start = live.last;
+	}
+	assert((guess = (int*) malloc(g->size*sizeof(int)))!=NULL && "Memory allocation error");
+	assert((warm = (double*) malloc(g->size*dim*sizeof(double)))!=NULL && "Memory allocation error");
+	guessBoard(b, start, guess, g);
+	for (i = 0 ; i < g->size ; i++){
+		for (v = 0 ; v < dim ; v++){
+			warm[i*dim + v] = (guess[i] == 0) ? -1.0 : (double) (guess[i] == v + 1);
 		}
 	}
-	free(cind);
+	error = setStart(live.model, warm, g->size*dim, from);
+	free(guess);
+	free(warm);
+	return error;
+}
+
+/*
+ * Called by GUROBI while optimizing, terminates the optimization once the stop flag in usrdata is set.
+ */
+int __stdcall stopCallback(CB_ARGS){
+	(void) cbdata;
+	(void) where;
+	if (*(volatile int*) usrdata){
+		GRBterminate(model);
+	}
 	return 0;
 }
 
 /*
- * Adds Sudoku constraints to the model.
- * Since the process of creating constraints for rows, columns and blocks is almost identical (appart from index calculations),
- * this function is generic and takes a flag: type indicating if we are currently working on rows (0), columns (1) or blocks (2)
+ * Adds all Sudoku constraints to the model with a single call, and sets *numConstrs to their number.
+ * The constraints are first built into one block, in the compressed row form GRBaddconstrs takes: constraint k has the
+ * variables ind[beg[k]..beg[k+1]-1], all with coefficient 1, and says exactly one of them is 1.
  *
- * General algorithm:
- * for each dimension (depending if we are working on rows columns or blocks):
- * 		for each possible value:
- * 				creates a constraint that this value can appear once in this dimension.
- * *
- * if during adding this constraint we discover there is no solution (i.e. there is no cell that can take a certain value):
+ * The constraints are:
+ * 		for each cell with variables: the cell receives a single assignment.
+ * 		for each row, column and block (rows first):
+ * 			for each value that doesn't appear in it: this value appears once in it.
+ *
+ * if while building the constraints we discover there is no solution (i.e. there is no cell that can take a certain value):
  * 		The function returns -1
  * if we had a GUROBI error, the function will return that error code
  * otherwise: it will return 0;
  */
-int addConst(int* b, GRBmodel* model , map* m, int dim, double* ones, int blockw, int blockh, int type){
-	int i, j, k, num, error=0, index, *cind, tmp;
-	assert ((cind = (int*) malloc(dim*sizeof(int)))!=NULL);
-	for (i = 0 ; i<dim ; i++){/*for each dimension*/
-		for (j = 1 ; j <= dim ; j++){ /*for each possible placment value*/
-			num = 0;
-			for (k=0 ; k < dim ; k++){/*for each cell in current dimension*/
-				index = getIndex(i, k, dim, blockw, blockh, type); /*we calculate the cells indices according to what dimension we are iterating over*/
-				if (b[index]==j){ /*no need to check this value*/
-					num = -1; /*it's okay no cells have a variable for this value as it already appears*/
-					break;
+int addConstrs(int* b, GRBmodel* model, map* m, int dim, int blockw, int blockh, int* numConstrs){
+	int i, j, k, type, var, index, num = 0, nnz = 0, found, error, size = dim*dim, total = GetNumVar(m), *beg, *ind;
+	double *ones;
+	char *sense;
+	/*every variable appears in 4 constraints (it's cell, row, column and block), there are at most 4*size of those*/
+	assert((beg = (int*) malloc((4*size + 4*total)*sizeof(int)))!=NULL && "Memory allocation error");
+	ind = beg + 4*size;
+	assert((ones = (double*) malloc((4*size + 4*total)*sizeof(double)))!=NULL && "Memory allocation error");
+	assert((sense = (char*) malloc(4*size*sizeof(char)))!=NULL && "Memory allocation error");
+	allOnes(ones, 4*size + 4*total); /*coefficients and right hand sides*/
+	memset(sense, GRB_EQUAL, 4*size);
+	for (i = 0 ; i < size ; i++){ /*a cell can receive only a single assignment*/
+		if (GetNumCell(m, i) == 0){
+			continue;
+		}
+		beg[num] = nnz;
+		for (var = GetFirstVar(m, i) ; var <= GetLastVar(m, i) ; var++){
+			ind[nnz] = var;
+			nnz++;
+		}
+		num++;
+	}
+	for (type = 0 ; type < 3 ; type++){ /*rows, cols and blocks*/
+		for (i = 0 ; i < dim ; i++){
+			for (j = 1 ; j <= dim ; j++){ /*for each possible placment value*/
+				beg[num] = nnz;
+				found = 0;
+				for (k = 0 ; k < dim && !found ; k++){
+					index = getIndex(i, k, dim, blockw, blockh, type);
+					found = (b[index] == j); /*no need for a constraint, the value already appears*/
+					if (!found && (var = getMapping(m, index, j)) >= 0){
+						ind[nnz] = var;
+						nnz++;
+					}
 				}
-				if ((tmp = getMapping(m, index, j))>=0){ /*cell[index] has variable for j value that needs to be considered in constraint*/
-					cind[num] = tmp;
-					num++;
+				if (found){
+					nnz = beg[num];
+					continue;
 				}
-			}
-			if (num>0){
-				error = GRBaddconstr(model, num, cind, ones, GRB_EQUAL, 1.0, NULL);
-			}
-			if (error || (!num)){ /*either an error or no cell can take this value*/
-				free(cind);
-				return (error ? error : -1);
+				if (nnz == beg[num]){ /*no cell can take this value*/
+					free(beg);
+					free(ones);
+					free(sense);
+					return -1;
+				}
+				num++;
 			}
 		}
 	}
-	free(cind);
-	return 0;
+	error = GRBaddconstrs(model, num, nnz, beg, ind, ones, sense, ones, NULL);
+	free(beg);
+	free(ones);
+	free(sense);
+	*numConstrs = num;
+	return error;
 }
+#endif
 
 /*
  * Returns a legal assignment for cell index in board, or 0 if none exist.
- * Receives an array representation of the board, index of cell and block sizes.
+ * Returns -1 if the solver failed.
+ * Receives an array representation of the board, index of cell, block sizes, the function solving the map's variables and
+ * it's stop flag.
  *
  * Assumes board is valid and index is legal.
  *
  */
-int hint(int* b, int index, int blockw, int blockh){
-	if (!solveB(b,blockw,blockh,1,index)){
-		return 0;
+int hint(int* b, int index, int blockw, int blockh, mapSolver solver, volatile int* stop){
+	int res = solveB(b,blockw,blockh,0,index,NULL,solver,stop);
+	if (res <= 0){
+		return res;
 	}
 	return (b[index]);
 }
@@ -260,21 +663,41 @@ void fill(int* b, map* m, double* sol){
 }
 
 /*
- * Returns the solution for specific cell.
+ * Fills the solution for specific cell.
  * This lets us giving hints to a user without the work of applying the solution of an entire board.
+ * A cell without variables was already filled before the optimizer ran, and is left as is.
  *
  * Recieves an array representation of the board, a map, the output of the optimizer, and the cell index.
  */
 void fillCell(int* b, map* m, double* sol, int index){
-	int var = GetFirstVar(m,index);
-	int end = GetLastVar(m,index);
-	while (var<=end){
-		if (sol[var]!=0){
+	int var = GetFirstVar(m,index), end = GetLastVar(m,index);
+	for ( ; var>=0 && var<=end ; var++){ /*exactly one of the cell's variables is set*/
+		if (sol[var]>0.5){
 			b[index] = getVal(m,index,var);
+			return;
 		}
 	}
 }
 
+/*
+ * Returns a new array with a value for every variable of map m: 1 if the variable places the value board start has in
+ * it's cell, 0 otherwise. All variables of cells of start that are empty or hold a value without a variable are -1 (no
+ * guess, see mapSolver).
+ */
+double* startVector(map* m, int* start){
+	double* warm;
+	int i, var, v;
+	assert((warm = (double*) malloc(GetNumVar(m)*sizeof(double)))!=NULL && "Memory allocation error");
+	for (i = 0 ; i < m->size ; i++){
+		var = (start[i] > 0) ? getMapping(m, i, start[i]) : -1;
+		for (v = m->first[i] ; v < m->first[i + 1] ; v++){
+			warm[v] = (var < 0) ? -1.0 : (double) (v == var);
+		}
+	}
+	return warm;
+}
+
+#ifndef NO_GUROBI
 /*
  * Fills type char array as GRB Binary.
  * Used to create the initial model.
@@ -286,18 +709,17 @@ void fillBinary(char* type,int total){
 	}
 }
 
+#endif
+
 /*
  * Calculates actual index in board of k'th cell in the i'th dim of type "type".
  * For example- find the index of 8th cell (k=8) in the third block on board (i=3, type=2)
  */
 int getIndex(int i, int k, int dim, int blockw, int blockh, int type){
-	switch (type){
-		case 0: return ((i*dim) + k); /*rows*/
-		case 1: return ((k*dim) + i); /*cols*/
-		default: return (translateBlockIndex(i, k, blockw, blockh));/*2 - block, from solver module*/
-	}
+	return getGeometry(blockw, blockh)->units[(type*dim + i)*dim + k]; /*rows, cols and blocks are units 0..3*dim-1 (in that order)*/
 }
 
+#ifndef NO_GUROBI
 /*
  * Receives a double array and size, fills it all with 1's.
  * Used for the Linear optimizer (as our constraints are always boring this way..)
@@ -308,3 +730,4 @@ void allOnes(double* ones, int total){
 		ones[i] = 1.0;
 	}
 }
+#endif
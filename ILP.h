@@ -12,35 +12,91 @@
 #ifndef ILP_H_
 #define ILP_H_
 
+#include "map.h"
+
+/*
+ * Returned by a mapSolver that was stopped before it found an answer.
+ */
+#define SOLVE_STOPPED 1
+
+/*
+ * Returned by a mapSolver that can't run at all (such as ILP when built without GUROBI).
+ */
+#define SOLVE_FAILED 2
+
+/*
+ * Solves the variables of map m for board b, and writes the solution to sol: sol[v] is 1 if variable v is true (the cell
+ * gets the value of that variable), 0 otherwise. Returns 0 if a solution was found, -1 if there is none, and a positive
+ * value if the solver failed (a GUROBI error code, or SOLVE_STOPPED).
+ * Receives the board, an initialized map (see map.h), array for solution (of the map's number of variables), the board's
+ * dimension, block dimensions, and stop: either NULL, or a flag that makes the solver give up once it's set (by another
+ * thread). ILP below and SAT of the sat module are such functions.
+ * start is either NULL, or a guess of the solution in the same form as sol (a warm start), that the solver may search
+ * around first. It doesn't have to be a solution, or even satisfy any of the constraints. The variables of a cell with no
+ * guess are all -1. ILP hands it to GUROBI as the MIP start (with no start, it makes one by a greedy fill of the board).
+ */
+typedef int (*mapSolver)(int* b, map* m, double* sol, int dim, int blockw, int blockh, double* start, volatile int* stop);
+
 /*
  * Returns whether the board is solvable or not (1/0), and applies a solution on input array b (if apply==1).
+ * Returns -1 if solver failed (see mapSolver), so whether the board is solvable is unknown.
  * ***apply==0 does not promise board will be unchanged, might edit board even if apply flag is turned off**
  *
- * Receives an array representing the board, block dimensions, flag whether to apply a solution if found, and a index cell that
- * denotes a single cell we wish to find a filling for.
+ * Receives an array representing the board, block dimensions, flag whether to apply a solution if found, a index cell that
+ * denotes a single cell we wish to find a filling for, a warm start (a full board close to a solution, or NULL), the
+ * function solving the map's variables and it's stop flag.
  *
  * Assumes that board is in a valid state as supplied, block sizes are valid and cell is a legal index in board.
  *
- * The solution is done by the ILP function (which works with GUROBI).
+ * The solution is done by solver: the ILP function (which works with GUROBI), or the SAT function (sat module).
  * This functions main role is to prime and initialize structures needed for the ILP.
  * To try and save work for the ILP, first assigns all cell which have only a single solution possible.
  *
  * If apply = 1
  * 		Fills the supplied array with the solution or returns 0 if impossible in current state.
- * If apply is negative, doesn't fill the whole array, but just the first cell with a hint for the cell in -(apply+1) index.
- * (this is used by the hint function and saves us the work of filling the entire array just to get 1 cell)
+ * If apply = 0 and cell is an index in the board, doesn't fill the whole array, but just that cell (cells filled by the
+ * deductions are filled anyway). This is used by the hint function and saves the work of filling the entire array just
+ * to get 1 cell.
  *
  */
-int solveB(int* b, int blockw, int blockh, int apply, int cell);
+int solveB(int* b, int blockw, int blockh, int apply, int cell, int* start, mapSolver solver, volatile int* stop);
 
 /*
- * Returns a legal assignment for cell index in board, or 0 if none exist.
- * Receives an array representation of the board, index of cell and block sizes.
+ * Returns a legal assignment for cell index in board, or 0 if none exist (-1 if the solver failed).
+ * Receives an array representation of the board, index of cell, block sizes, the function solving the map's variables and
+ * it's stop flag.
  *
  * Assumes board is valid and index is legal.
  *
  */
-int hint(int* b, int index, int blockw, int blockh);
+int hint(int* b, int index, int blockw, int blockh, mapSolver solver, volatile int* stop);
+
+/*
+ * Creates the ILP model for the variables of map m, runs it with GUROBI and returns the solution in sol (see mapSolver).
+ * If stop is set while optimizing, the optimization is terminated. The GUROBI parameters are taken from settings.h.
+ * When built without GUROBI (NO_GUROBI defined), always fails.
+ */
+int ILP(int* b, map *m, double* sol, int dim, int blockw, int blockh, double* start, volatile int* stop);
+
+/*
+ * Frees the GUROBI environment kept by ILP between calls (it's loaded once, on the first call, as loading it checks out
+ * a license). Called once the optimizer is not needed anymore, at exit.
+ * All GUROBI calls of this module are made under one lock, as GUROBI doesn't allow models of the same environment to be
+ * used on several threads at once: boards solved on several threads (by the portfolio) are optimized one at a time.
+ */
+void freeILP(void);
+
+/*
+ * Returns 1 if board b is solvable and fills it with a solution, 0 if it has no solution, or -1 if GUROBI failed or was
+ * stopped by stop (see mapSolver).
+ * Unlike solveB with ILP, the GUROBI model is kept between calls, and only the cells that changed since the last call
+ * change it (set, undo and redo change a few cells), so GUROBI re-solves it instead of starting over. The model has a
+ * variable for every value of every cell, and leaves the deductions made before the ILP in solveB to GUROBI's presolve.
+ * It's built again only for boards of different block sizes. When built without GUROBI, always fails.
+ * The MIP start is start (a board close to a solution, or NULL), otherwise the last solution the model found, with the
+ * values that clash with b dropped and the cells left filled greedily.
+ */
+int liveSolve(int* b, int blockw, int blockh, int* start, volatile int* stop);
 
 
 #endif /* ILP_H_ */
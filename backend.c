@@ -0,0 +1,206 @@
+/*
+ * backend.c
+ *
+ *	The table of engines and the small adapters fitting every engine's functions to the operations of a backend.
+ *	See header for the engines and how missing operations are handled.
+ *
+ *  Created on: Jul 22, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "backend.h"
+#include "ILP.h"
+#include "sat.h"
+#include "dlx.h"
+#include "solver.h"
+#include "settings.h"
+#include "portfolio.h"
+
+int gurobiSolve(int* b, int blockw, int blockh, int* start, volatile int* stop);
+int gurobiHint(int* b, int index, int blockw, int blockh, volatile int* stop);
+int satSolve(int* b, int blockw, int blockh, int* start, volatile int* stop);
+int satHint(int* b, int index, int blockw, int blockh, volatile int* stop);
+int dlxHint(int* b, int index, int blockw, int blockh, volatile int* stop);
+void dlxCountOp(int* b, int blockw, int blockh, bitmask* cands, int limit, bigNum* count);
+void bitmaskCountOp(int* b, int blockw, int blockh, bitmask* cands, int limit, bigNum* count);
+int backtrackSolveOp(int* b, int blockw, int blockh, int* start, volatile int* stop);
+int backtrackHint(int* b, int index, int blockw, int blockh, volatile int* stop);
+void backtrackCountOp(int* b, int blockw, int blockh, bitmask* cands, int limit, bigNum* count);
+int autoSolve(int* b, int blockw, int blockh, int* start, volatile int* stop);
+int autoHint(int* b, int index, int blockw, int blockh, volatile int* stop);
+backend* autoPick(int* b, int blockw, int blockh);
+
+/*
+ * Engines in the order of the engine enum (settings.h).
+ */
+backend backends[NUM_ENGINES] = {
+#ifdef NO_GUROBI
+		{"gurobi", NULL, NULL, NULL},
+#else
+		{"gurobi", gurobiSolve, gurobiHint, NULL},
+#endif
+		{"sat", satSolve, satHint, NULL},
+		{"dlx", dlxSolve, dlxHint, dlxCountOp},
+		{"bitmask", NULL, NULL, bitmaskCountOp},
+		{"backtrack", backtrackSolveOp, backtrackHint, backtrackCountOp},
+		{"auto", autoSolve, autoHint, dlxCountOp},
+		{"portfolio", portfolioSolve, portfolioHint, NULL}
+};
+
+/*
+ * Returns the operations of engine e.
+ */
+backend* getBackend(engine e){
+	return &backends[e];
+}
+
+/*
+ * Solves board b with the solver chosen in settings (see header).
+ */
+int backendSolve(int* b, int blockw, int blockh, int* start){
+	backend* be = getBackend(getSettings()->solver);
+	if (be->solve == NULL){
+		be = getBackend(engineAuto);
+	}
+	return be->solve(b, blockw, blockh, start, NULL);
+}
+
+/*
+ * Finds a value for cell index of board b with the solver chosen in settings (see header).
+ */
+int backendHint(int* b, int index, int blockw, int blockh){
+	backend* be = getBackend(getSettings()->solver);
+	if (be->hint == NULL){
+		be = getBackend(engineAuto);
+	}
+	return be->hint(b, index, blockw, blockh, NULL);
+}
+
+/*
+ * Counts the solutions of board b with the counter chosen in settings (see header).
+ */
+void backendCount(int* b, int blockw, int blockh, bitmask* cands, int limit, bigNum* count){
+	backend* be = getBackend(getSettings()->counter);
+	if (be->count == NULL){
+		be = getBackend(engineDlx);
+	}
+	be->count(b, blockw, blockh, cands, limit, count);
+}
+
+#ifndef NO_GUROBI
+/*
+ * Solves board b with the GUROBI optimizer, with the model kept between calls if it's not turned off in settings (and
+ * with a model of it's own if that fails).
+ */
+int gurobiSolve(int* b, int blockw, int blockh, int* start, volatile int* stop){
+	int res;
+	if (getSettings()->grbIncremental && (res = liveSolve(b, blockw, blockh, start, stop)) >= 0){
+		return res;
+	}
+	return solveB(b, blockw, blockh, 1, -1, start, ILP, stop);
+}
+
+/*
+ * Finds a value for cell index of board b with the GUROBI optimizer.
+ */
+int gurobiHint(int* b, int index, int blockw, int blockh, volatile int* stop){
+	int res;
+	if (getSettings()->grbIncremental && (res = liveSolve(b, blockw, blockh, NULL, stop)) >= 0){
+		return (res == 1) ? b[index] : 0;
+	}
+	return hint(b, index, blockw, blockh, ILP, stop);
+}
+#endif
+
+/*
+ * Solves board b with the SAT solver.
+ */
+int satSolve(int* b, int blockw, int blockh, int* start, volatile int* stop){
+	return solveB(b, blockw, blockh, 1, -1, start, SAT, stop);
+}
+
+/*
+ * Finds a value for cell index of board b with the SAT solver.
+ */
+int satHint(int* b, int index, int blockw, int blockh, volatile int* stop){
+	return hint(b, index, blockw, blockh, SAT, stop);
+}
+
+/*
+ * Finds a value for cell index of board b with Dancing Links.
+ */
+int dlxHint(int* b, int index, int blockw, int blockh, volatile int* stop){
+	int res = dlxSolve(b, blockw, blockh, NULL, stop);
+	return (res == 1) ? b[index] : res;
+}
+
+/*
+ * Counts the solutions of board b with Dancing Links.
+ */
+void dlxCountOp(int* b, int blockw, int blockh, bitmask* cands, int limit, bigNum* count){
+	(void) cands;
+	dlxSearch(b, blockw, blockh, limit, NULL, NULL, count);
+}
+
+/*
+ * Counts the solutions of board b with the bitmask engine, using the heuristics chosen in settings.
+ */
+void bitmaskCountOp(int* b, int blockw, int blockh, bitmask* cands, int limit, bigNum* count){
+	bitCountLimit(b, blockw, blockh, getSettings()->countFlags, cands, limit, count);
+}
+
+/*
+ * Solves board b with the num_solutions search, which always tries values in increasing order (start is ignored).
+ */
+int backtrackSolveOp(int* b, int blockw, int blockh, int* start, volatile int* stop){
+	(void) start;
+	return backtrackSolve(b, blockw, blockh, stop);
+}
+
+/*
+ * Finds a value for cell index of board b with the num_solutions search.
+ */
+int backtrackHint(int* b, int index, int blockw, int blockh, volatile int* stop){
+	int res = backtrackSolve(b, blockw, blockh, stop);
+	return (res == 1) ? b[index] : res;
+}
+
+/*
+ * Counts the solutions of board b with the num_solutions search.
+ */
+void backtrackCountOp(int* b, int blockw, int blockh, bitmask* cands, int limit, bigNum* count){
+	(void) cands;
+	boundedSolutions(b, blockw, blockh, limit, count);
+}
+
+/*
+ * Solves board b with the engine auto picks for it.
+ */
+int autoSolve(int* b, int blockw, int blockh, int* start, volatile int* stop){
+	return autoPick(b, blockw, blockh)->solve(b, blockw, blockh, start, stop);
+}
+
+/*
+ * Finds a value for cell index of board b with the engine auto picks for it.
+ */
+int autoHint(int* b, int index, int blockw, int blockh, volatile int* stop){
+	return autoPick(b, blockw, blockh)->hint(b, index, blockw, blockh, stop);
+}
+
+/*
+ * Returns the engine used by auto to solve board b: Dancing Links for small or nearly empty boards, where it finds a
+ * solution almost without backtracking, and the SAT solver for big boards with more filled cells, where the givens often
+ * lead Dancing Links into long dead ends that the SAT solver's learnt clauses cut short.
+ */
+backend* autoPick(int* b, int blockw, int blockh){
+	int dim = blockw*blockh, size = dim*dim, filled = 0, i;
+	if (dim <= AUTO_DLX_DIM){
+		return getBackend(engineDlx);
+	}
+	for (i = 0 ; i < size ; i++){
+		filled += (b[i] != 0);
+	}
+	return getBackend((100*filled < AUTO_SAT_FILL*size) ? engineDlx : engineSat);
+}
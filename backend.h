@@ -0,0 +1,80 @@
+/*
+ * backend.h
+ *
+ *	Puts all the engines that solve boards and count their solutions behind a single interface, so commands don't depend on
+ *	any particular engine, and the engine can be chosen at runtime (see settings.h).
+ *
+ *	Every engine is a table of operations (a backend). An operation an engine doesn't support is NULL, and the calls below
+ *	fall back to another engine for it: solving falls back to "auto", counting to "dlx".
+ *
+ *		"gurobi" - solve and hint with the GUROBI optimizer (ILP module). Left without operations when built without GUROBI.
+ *		"sat" - solve and hint with the CDCL SAT solver (sat module).
+ *		"dlx" - solve, hint and count with Dancing Links (dlx module).
+ *		"bitmask" - count with the bitmask backtracking (bitSolver module).
+ *		"backtrack" - solve, hint and count with the pseudo recursive search of num_solutions (solver module).
+ *		"auto" - solves boards up to AUTO_DLX_DIM values, and bigger boards with less than AUTO_SAT_FILL percent of their cells
+ *			filled, with "dlx" and the rest with "sat". Counts with "dlx".
+ *		"portfolio" - solves and hints by racing several engines on their own threads (portfolio module).
+ *
+ *  Created on: Jul 22, 2019
+ *      Author: Edanz
+ */
+
+#ifndef BACKEND_H_
+#define BACKEND_H_
+
+#include "settings.h"
+#include "bigNum.h"
+#include "bitSolver.h"
+
+#define AUTO_DLX_DIM 16
+#define AUTO_SAT_FILL 20
+
+typedef struct S_backend{
+	char* name;
+	/*
+	 * Returns 1 if board b is solvable and fills it with a solution, 0 otherwise (b might be changed either way).
+	 * Returns -1 if the engine failed, or gave up because stop was set (stop is either NULL, or a flag set by another
+	 * thread once the answer isn't needed anymore).
+	 * start is either NULL, or a full board close to a solution of b (such as a solution of b before a few changes), that
+	 * the engine searches around first. It doesn't have to agree with b, and engines may ignore it.
+	 */
+	int (*solve)(int* b, int blockw, int blockh, int* start, volatile int* stop);
+	/*
+	 * Returns a value for cell index of board b that keeps it solvable, or 0 if b has no solution (b might be changed).
+	 * Returns -1 if the engine failed or gave up, same as solve.
+	 */
+	int (*hint)(int* b, int index, int blockw, int blockh, volatile int* stop);
+	/*
+	 * Adds the number of solutions of board b to count, stopping once count reaches limit (if limit is positive).
+	 * cands is either NULL, or holds the values still possible in every cell (engines may ignore it). b is not changed.
+	 */
+	void (*count)(int* b, int blockw, int blockh, bitmask* cands, int limit, bigNum* count);
+} backend;
+
+/*
+ * Returns the operations of engine e.
+ */
+backend* getBackend(engine e);
+
+/*
+ * Returns 1 if board b is solvable and fills it with a solution, 0 otherwise, with the solver chosen in settings.
+ * Receives the board in 1d array form and block sizes. Assumes the board is valid. b might be changed even if it has no
+ * solution. Returns -1 if the engine failed (such as GUROBI without a license), so whether b is solvable is unknown.
+ * start is either NULL or a warm start for the engine (see the solve operation above).
+ */
+int backendSolve(int* b, int blockw, int blockh, int* start);
+
+/*
+ * Returns a value for cell index of board b that keeps it solvable, or 0 if b has no solution, with the solver chosen in
+ * settings. Same assumptions as backendSolve, and -1 if the engine failed.
+ */
+int backendHint(int* b, int index, int blockw, int blockh);
+
+/*
+ * Adds the number of solutions of board b to count with the counter chosen in settings, stopping once count reaches limit
+ * (if limit is positive). cands is either NULL, or holds the values still possible in every cell. b is not changed.
+ */
+void backendCount(int* b, int blockw, int blockh, bitmask* cands, int limit, bigNum* count);
+
+#endif /* BACKEND_H_ */
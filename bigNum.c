@@ -0,0 +1,150 @@
+/*
+ * bigNum.c
+ *
+ *	Arithmetic on wide counters. See header for the representation.
+ *
+ *  Created on: Jul 12, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "bigNum.h"
+
+#define BIG_BASE (1UL << BIG_LIMB_BITS)
+#define BIG_MASK (BIG_BASE - 1)
+
+void addAt(bigNum* n, int i, unsigned long val);
+
+/*
+ * Sets n to val. Assumes 0 <= val < 2^32.
+ */
+void bigSet(bigNum* n, unsigned long val){
+	int i;
+	for (i = 0 ; i < BIG_LIMBS ; i++){
+		n->limb[i] = 0;
+	}
+	n->overflow = 0;
+	n->limb[0] = val & BIG_MASK;
+	n->limb[1] = (val >> BIG_LIMB_BITS) & BIG_MASK;
+}
+
+/*
+ * Adds 1 to n.
+ */
+void bigInc(bigNum* n){
+	addAt(n, 0, 1);
+}
+
+/*
+ * Adds m to n.
+ */
+void bigAdd(bigNum* n, bigNum* m){
+	int i;
+	for (i = 0 ; i < BIG_LIMBS ; i++){
+		if (m->limb[i] != 0){
+			addAt(n, i, m->limb[i]);
+		}
+	}
+	n->overflow |= m->overflow;
+}
+
+/*
+ * Multiplies n by factor. Assumes 0 <= factor < 2^16.
+ * Every digit product is smaller than 2^32 - 2^17, so adding the carry (smaller than 2^16) to it can't overflow.
+ */
+void bigMul(bigNum* n, unsigned long factor){
+	unsigned long carry = 0, tmp;
+	int i;
+	for (i = 0 ; i < BIG_LIMBS ; i++){
+		tmp = n->limb[i]*factor + carry;
+		n->limb[i] = tmp & BIG_MASK;
+		carry = tmp >> BIG_LIMB_BITS;
+	}
+	if (carry != 0){
+		n->overflow = 1;
+	}
+}
+
+/*
+ * Returns 1 if n >= val, 0 otherwise. Assumes val is non negative.
+ */
+int bigAtLeast(bigNum* n, int val){
+	int i;
+	bigNum tmp;
+	if (n->overflow){
+		return 1;
+	}
+	bigSet(&tmp, (unsigned long) val);
+	for (i = BIG_LIMBS - 1 ; i >= 0 ; i--){
+		if (n->limb[i] != tmp.limb[i]){
+			return (n->limb[i] > tmp.limb[i]);
+		}
+	}
+	return 1;
+}
+
+/*
+ * Returns n as an int, or -1 if it doesn't fit in one (or overflowed).
+ */
+int bigToInt(bigNum* n){
+	int i;
+	unsigned long val;
+	if (n->overflow){
+		return -1;
+	}
+	for (i = 2 ; i < BIG_LIMBS ; i++){
+		if (n->limb[i] != 0){
+			return -1;
+		}
+	}
+	val = (n->limb[1] << BIG_LIMB_BITS) | n->limb[0];
+	return (val > (unsigned long) INT_MAX) ? -1 : (int) val;
+}
+
+/*
+ * Writes the decimal form of n to str, which must have room for BIG_STR_LEN chars.
+ * Digits are found by repeated division by 10 (from the most significant digit of n down), so they come out in reverse.
+ */
+void bigToString(bigNum* n, char* str){
+	bigNum tmp = *n;
+	unsigned long rem;
+	int i, len = 0, nonZero = 1;
+	char c;
+	while (nonZero){
+		rem = 0;
+		nonZero = 0;
+		for (i = BIG_LIMBS - 1 ; i >= 0 ; i--){
+			rem = (rem << BIG_LIMB_BITS) | tmp.limb[i];
+			tmp.limb[i] = rem / 10;
+			rem %= 10;
+			if (tmp.limb[i] != 0){
+				nonZero = 1;
+			}
+		}
+		str[len] = (char) ('0' + rem);
+		len++;
+	}
+	str[len] = '\0';
+	for (i = 0 ; i < len/2 ; i++){
+		c = str[i];
+		str[i] = str[len - 1 - i];
+		str[len - 1 - i] = c;
+	}
+}
+
+/*
+ * Adds val (smaller than 2^16) to digit i of n, and carries the rest up.
+ */
+void addAt(bigNum* n, int i, unsigned long val){
+	unsigned long carry = val;
+	for ( ; carry != 0 && i < BIG_LIMBS ; i++){
+		carry += n->limb[i];
+		n->limb[i] = carry & BIG_MASK;
+		carry >>= BIG_LIMB_BITS;
+	}
+	if (carry != 0){
+		n->overflow = 1;
+	}
+}
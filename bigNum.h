@@ -0,0 +1,62 @@
+/*
+ * bigNum.h
+ *
+ *	Non negative integers wider than int, used to count solutions.
+ *
+ *	ANSI C has no integer type that is guaranteed to be wider than 32 bits, so a number is kept as an array of BIG_LIMBS
+ *	"digits" in base 2^16 (least significant first), each stored in an unsigned long. Products and sums of two digits
+ *	always fit in an unsigned long, so no wider type is ever needed.
+ *	A number that grows beyond BIG_LIMBS digits is marked as overflowed (and keeps it's lowest digits).
+ *
+ *  Created on: Jul 12, 2019
+ *      Author: Edanz
+ */
+
+#ifndef BIGNUM_H_
+#define BIGNUM_H_
+
+#define BIG_LIMBS 8 /*128 bits*/
+#define BIG_LIMB_BITS 16
+#define BIG_STR_LEN 48 /*enough for the decimal form of any bigNum and a terminating null*/
+
+typedef struct S_bigNum{
+	unsigned long limb[BIG_LIMBS];
+	int overflow; /*1 if the number exceeded the largest value that can be held*/
+} bigNum;
+
+/*
+ * Sets n to val. Assumes 0 <= val < 2^32.
+ */
+void bigSet(bigNum* n, unsigned long val);
+
+/*
+ * Adds 1 to n.
+ */
+void bigInc(bigNum* n);
+
+/*
+ * Adds m to n.
+ */
+void bigAdd(bigNum* n, bigNum* m);
+
+/*
+ * Multiplies n by factor. Assumes 0 <= factor < 2^16.
+ */
+void bigMul(bigNum* n, unsigned long factor);
+
+/*
+ * Returns 1 if n >= val, 0 otherwise. Assumes val is non negative.
+ */
+int bigAtLeast(bigNum* n, int val);
+
+/*
+ * Returns n as an int, or -1 if it doesn't fit in one (or overflowed).
+ */
+int bigToInt(bigNum* n);
+
+/*
+ * Writes the decimal form of n to str, which must have room for BIG_STR_LEN chars.
+ */
+void bigToString(bigNum* n, char* str);
+
+#endif /* BIGNUM_H_ */
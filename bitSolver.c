@@ -0,0 +1,478 @@
+/*
+ * bitSolver.c
+ *
+ *	Bitmask based solution counter. See header for the representation.
+ *
+ *	The search itself is the same exhaustive backtracking done by num_solutions: each empty cell tries all it's valid
+ *	values and a full assignment is counted as a solution.
+ *	The difference is in how a valid value is found:
+ *		- the remaining candidates of every cell on the current path are kept as a mask, so moving to the next value is
+ *		  clearing the lowest bit rather than testing all values one by one.
+ *		- placing / removing a value only toggles one bit in the row, column and block masks.
+ *	As the empty cells are known in advance, the "recursion stack" is just the depth in the array of empty cells,
+ *	so the loop itself does no memory actions at all.
+ *
+ *	Two optional heuristics (see COUNT_* flags in the header) decide which cell is filled next and in what order it's
+ *	values are tried. The count itself does not depend on them, only the size of the search tree.
+ *
+ *	With COUNT_MEMO, the number of solutions below every state is kept in a transposition table. What is left to search
+ *	depends only on which cells are filled and on the values in every row, column and block (not on where in the unit
+ *	they are), so a state is keyed by a Zobrist hash of these: a random word for every filled cell and for every
+ *	(unit, value) pair in use, XORed together. Placing or removing a value toggles four words, so the hash is kept up to
+ *	date at no real cost. Two different assignments leave the same state when values are swapped between cells that
+ *	share their units (such as the corners of a rectangle inside a band), which is common on sparse rectangular boards.
+ *
+ *  Created on: Jul 3, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "solver.h"
+#include "bitSolver.h"
+#include "geometry.h"
+#include "memo.h"
+#include "settings.h"
+
+#define MEMO_MIN_OPEN 16 /*fewest empty cells left in a state for it to be looked up in the memo table*/
+
+/*
+ * State of a single count. Positions [0,depth) of the empty cells array are filled, the rest are still empty.
+ */
+typedef struct S_bitSearch{
+	int dim;
+	int blockW;
+	int blockH;
+	geometry* g;
+	int numEmpty;
+	int flags;
+	bitmask full; /*mask of all legal values*/
+	bitmask *rows, *cols, *blocks; /*occupancy masks*/
+	int *cellAt, *rowOf, *colOf, *blockOf; /*position in empty cells array -> cell index and it's row, col and block*/
+	int *freeRows, *freeCols, *freeBlocks; /*number of empty cells in every row, column and block (used as degree)*/
+	bitmask *cellVal; /*value currently placed in every cell of the board, as a single bit (0 if empty)*/
+	bitmask *allowed; /*values that may be placed in every cell of the board*/
+	bitmask *cand; /*values not tried yet for the cell in every position*/
+	bitmask *placed; /*value currently placed in the cell in every position*/
+	bitmask *order; /*with COUNT_LCV: the values of every position, in the order they should be tried*/
+	int *next; /*with COUNT_LCV: index in order of the next value to try in every position*/
+	memoTable* memo; /*with COUNT_MEMO (and no limit): the transposition table, otherwise NULL*/
+	unsigned long *zobrist; /*2 random words for every (unit, value) pair followed by 2 for every cell*/
+	unsigned long hash[2]; /*hash of the current state*/
+	unsigned long *keys; /*hash of the state entered at every depth*/
+	unsigned long *sub; /*solutions found so far below the state entered at every depth (at most MEMO_MAX_COUNT)*/
+	int *keep; /*1 if the count of the state at a depth should be stored when leaving it*/
+} bitSearch;
+
+void initBitSearch(bitSearch* s, int* b, int blockW, int blockH, int flags, bitmask* allowed);
+void freeBitSearch(bitSearch* s);
+void choose(bitSearch* s, int depth);
+void orderValues(bitSearch* s, int depth);
+void place(bitSearch* s, int depth, bitmask bit);
+void removeVal(bitSearch* s, int depth);
+void initMemoSearch(bitSearch* s, memoTable* t);
+void enterState(bitSearch* s, int depth, bigNum* count);
+void leaveState(bitSearch* s, int depth);
+void toggleHash(bitSearch* s, int depth, bitmask bit);
+int bitNum(bitmask m);
+
+/*
+ * Counts number of solutions possible for current board and returns it (0 if none, -1 if it doesn't fit in an int).
+ * Returns exactly what num_solutions returns for the same board, but usually does so much faster.
+ *
+ * Receives board in 1d array form, block sizes and a combination of COUNT_* flags choosing the search heuristics.
+ * The array is not modified.
+ * Assumes legal board size and matching block sizes.
+ *
+ * Boards with more than MAX_BIT_DIM values are handed over to num_solutions.
+ */
+int bitCount(int* b, int blockW, int blockH, int flags){
+	bigNum count;
+	bigSet(&count, 0);
+	bitCountLimit(b, blockW, blockH, flags, NULL, 0, &count);
+	return bigToInt(&count);
+}
+
+/*
+ * Same as bitCount, but adds the number of solutions found to count, and stops as soon as count reaches limit
+ * (searches exhaustively if limit <= 0).
+ * allowed is either NULL, or holds a mask for every cell, and only values in it's cell's mask are tried for an empty cell.
+ *
+ * Algorithm:
+ * 		1. build the row, column and block masks from the board, and an array of all empty cells.
+ * 		2. cand[d] holds the values that were not tried yet for the d'th filled cell, and placed[d] the value currently in it.
+ * 		3. when reaching depth d, pick the cell to fill in it (choose), and compute it's candidates.
+ * 		4. in each iteration we take the next untried candidate of the current cell, place it and go one cell deeper.
+ * 		   if there are no candidates left, we go back one cell and remove the value placed there.
+ * 		   if we placed a value in the last empty cell, we found a solution.
+ * 		5. with the memo table, solutions are also counted in sub[d] of the deepest state, which is added to it's parent's
+ * 		   when leaving it (after storing it in the table). A state found in the table isn't searched at all, it's count
+ * 		   is added to count and to it's parent's right away.
+ */
+void bitCountLimit(int* b, int blockW, int blockH, int flags, bitmask* allowed, int limit, bigNum* count){
+	int depth;
+	bitmask bit;
+	bitSearch s;
+	memoTable table;
+	if (blockW*blockH > MAX_BIT_DIM){
+		boundedSolutions(b, blockW, blockH, limit, count);
+		return;
+	}
+	initBitSearch(&s, b, blockW, blockH, flags, allowed);
+	if (s.numEmpty == 0){ /*a full board is it's own single solution (same as num_solutions)*/
+		freeBitSearch(&s);
+		bigInc(count);
+		return;
+	}
+	if ((flags & COUNT_MEMO) && limit <= 0){
+		initMemoSearch(&s, &table);
+	}
+	depth = 0;
+	enterState(&s, 0, count);
+	while (depth >= 0){
+		if (s.cand[depth] == 0){ /*no more values to try in this cell, backtrack and clear the value placed in previous cell*/
+			if (s.memo != NULL){
+				leaveState(&s, depth);
+			}
+			depth--;
+			if (depth >= 0){
+				removeVal(&s, depth);
+			}
+			continue;
+		}
+		if (s.flags & COUNT_LCV){
+			bit = s.order[depth*s.dim + s.next[depth]];
+			s.next[depth]++;
+		}
+		else{
+			bit = s.cand[depth] & (~(s.cand[depth]) + 1); /*lowest candidate left*/
+		}
+		s.cand[depth] ^= bit;
+		if (depth == s.numEmpty - 1){ /*a legal placement to the last empty cell*/
+			bigInc(count);
+			if (s.memo != NULL){
+				s.sub[depth]++; /*never saturates, it's the count of a single cell*/
+			}
+			if (limit > 0 && bigAtLeast(count, limit)){
+				break;
+			}
+			continue;
+		}
+		place(&s, depth, bit);
+		depth++;
+		enterState(&s, depth, count);
+	}
+	if (s.memo != NULL && getSettings()->stats){
+		printMemoStats(s.memo);
+	}
+	freeBitSearch(&s);
+}
+
+/*
+ * Builds the masks and the array of empty cells of board b.
+ */
+void initBitSearch(bitSearch* s, int* b, int blockW, int blockH, int flags, bitmask* allowed){
+	int dim = blockW*blockH, size = dim*dim, i, r, c, k, n = 0;
+	bitmask bit;
+	s->dim = dim;
+	s->blockW = blockW;
+	s->blockH = blockH;
+	s->g = getGeometry(blockW, blockH);
+	s->flags = flags;
+	s->full = (dim == MAX_BIT_DIM) ? ~((bitmask) 0) : ((((bitmask) 1) << dim) - 1);
+	assert((s->rows = (bitmask*) calloc(3*dim + 2*size, sizeof(bitmask)))!=NULL && "Memory allocation error");
+	s->cols = s->rows + dim;
+	s->blocks = s->cols + dim;
+	s->cellVal = s->blocks + dim;
+	s->allowed = s->cellVal + size;
+	assert((s->cellAt = (int*) malloc((4*size + 3*dim)*sizeof(int)))!=NULL && "Memory allocation error");
+	s->rowOf = s->cellAt + size;
+	s->colOf = s->rowOf + size;
+	s->blockOf = s->colOf + size;
+	s->freeRows = s->blockOf + size;
+	s->freeCols = s->freeRows + dim;
+	s->freeBlocks = s->freeCols + dim;
+	assert((s->cand = (bitmask*) malloc(2*(size+1)*sizeof(bitmask)))!=NULL && "Memory allocation error");
+	s->placed = s->cand + size + 1;
+	s->order = NULL;
+	s->next = NULL;
+	s->memo = NULL;
+	if (flags & COUNT_LCV){
+		assert((s->order = (bitmask*) malloc(size*dim*sizeof(bitmask)))!=NULL && "Memory allocation error");
+		assert((s->next = (int*) malloc(size*sizeof(int)))!=NULL && "Memory allocation error");
+	}
+	for (i = 0 ; i < dim ; i++){
+		s->freeRows[i] = 0;
+		s->freeCols[i] = 0;
+		s->freeBlocks[i] = 0;
+	}
+	for (i = 0 ; i < size ; i++){
+		r = s->g->rowOf[i];
+		c = s->g->colOf[i];
+		k = s->g->blockOf[i];
+		s->allowed[i] = (allowed == NULL) ? s->full : (allowed[i] & s->full);
+		if (b[i] == 0){
+			s->cellAt[n] = i;
+			s->rowOf[n] = r;
+			s->colOf[n] = c;
+			s->blockOf[n] = k;
+			s->freeRows[r]++;
+			s->freeCols[c]++;
+			s->freeBlocks[k]++;
+			n++;
+			continue;
+		}
+		bit = ((bitmask) 1) << (b[i] - 1);
+		s->cellVal[i] = bit;
+		s->rows[r] |= bit;
+		s->cols[c] |= bit;
+		s->blocks[k] |= bit;
+	}
+	s->numEmpty = n;
+}
+
+/*
+ * frees all space allocated to the search.
+ */
+void freeBitSearch(bitSearch* s){
+	free(s->rows);
+	free(s->cellAt);
+	free(s->cand);
+	free(s->order);
+	free(s->next);
+	if (s->memo != NULL){
+		freeMemo(s->memo);
+		free(s->zobrist);
+		free(s->keys);
+		free(s->sub);
+		free(s->keep);
+	}
+}
+
+/*
+ * Starts keeping state counts in table t, with the memory budget set in settings.
+ *
+ * The hash words are a fixed function of their index, so counts don't depend on the run. They are made by a
+ * multiplicative mixer rather than a shift / XOR generator: the words of such a generator are all XORs of the bits of
+ * it's seed, so many different sets of words XOR to the same hash, and different states collide.
+ */
+void initMemoSearch(bitSearch* s, memoTable* t){
+	int i, n = 2*(3*s->dim*s->dim + s->dim*s->dim);
+	initMemo(t, getSettings()->memoSize);
+	s->memo = t;
+	assert((s->zobrist = (unsigned long*) malloc(n*sizeof(unsigned long)))!=NULL && "Memory allocation error");
+	for (i = 0 ; i < n ; i++){ /*the high half is lost where unsigned long has only 32 bits*/
+		s->zobrist[i] = ((mix32(2*i) << 16) << 16) ^ mix32(2*i + 1);
+	}
+	s->hash[0] = 0;
+	s->hash[1] = 0;
+	assert((s->keys = (unsigned long*) malloc(2*s->numEmpty*sizeof(unsigned long)))!=NULL && "Memory allocation error");
+	assert((s->sub = (unsigned long*) malloc(s->numEmpty*sizeof(unsigned long)))!=NULL && "Memory allocation error");
+	assert((s->keep = (int*) malloc(s->numEmpty*sizeof(int)))!=NULL && "Memory allocation error");
+}
+
+/*
+ * Moves the search into the state at depth: looks it up in the memo table (if used) and, unless it was found there,
+ * chooses the cell to fill at depth. The count of a state found in the table is added to count, and the state is left
+ * with no candidates, so it's left right away.
+ */
+void enterState(bitSearch* s, int depth, bigNum* count){
+	bigNum found;
+	if (s->memo != NULL){
+		s->keys[2*depth] = s->hash[0];
+		s->keys[2*depth + 1] = s->hash[1];
+		s->sub[depth] = 0;
+		s->keep[depth] = (s->numEmpty - depth >= MEMO_MIN_OPEN);
+		if (s->keep[depth] && memoGet(s->memo, s->hash[0], s->hash[1], s->sub + depth)){
+			bigSet(&found, s->sub[depth]);
+			bigAdd(count, &found);
+			s->keep[depth] = 0;
+			s->cand[depth] = 0;
+			return;
+		}
+	}
+	choose(s, depth);
+}
+
+/*
+ * Leaves the state at depth once all of it's values were tried: stores it's count in the memo table (unless it came from
+ * there, or it is too large to store) and adds it to the count of the state above it.
+ * A state with a count too large to store marks the one above it the same way.
+ */
+void leaveState(bitSearch* s, int depth){
+	if (s->keep[depth]){
+		memoPut(s->memo, s->keys[2*depth], s->keys[2*depth + 1], s->sub[depth]);
+	}
+	if (depth == 0){
+		return;
+	}
+	if (s->sub[depth] == MEMO_MAX_COUNT || s->sub[depth] > MEMO_MAX_COUNT - s->sub[depth - 1]){
+		s->sub[depth - 1] = MEMO_MAX_COUNT; /*saturated, never stored*/
+		s->keep[depth - 1] = 0;
+	}
+	else{
+		s->sub[depth - 1] += s->sub[depth];
+	}
+}
+
+/*
+ * Returns a well mixed 32 bit word made from x (see header).
+ */
+unsigned long mix32(unsigned long x){
+	x = (x*0x9E3779B9UL + 0x7F4A7C15UL) & 0xFFFFFFFFUL;
+	x ^= x >> 16;
+	x = (x*0x85EBCA6BUL) & 0xFFFFFFFFUL;
+	x ^= x >> 13;
+	x = (x*0xC2B2AE35UL) & 0xFFFFFFFFUL;
+	x ^= x >> 16;
+	return x;
+}
+
+/*
+ * Toggles value bit of the cell at position depth in the state hash.
+ */
+void toggleHash(bitSearch* s, int depth, bitmask bit){
+	int v = lowestBit(bit), dim = s->dim;
+	unsigned long *row = s->zobrist + 2*(s->rowOf[depth]*dim + v), *col = s->zobrist + 2*((dim + s->colOf[depth])*dim + v);
+	unsigned long *block = s->zobrist + 2*((2*dim + s->blockOf[depth])*dim + v);
+	unsigned long *cell = s->zobrist + 2*(3*dim*dim + s->cellAt[depth]);
+	s->hash[0] ^= row[0] ^ col[0] ^ block[0] ^ cell[0];
+	s->hash[1] ^= row[1] ^ col[1] ^ block[1] ^ cell[1];
+}
+
+/*
+ * Decides which of the cells still empty is filled at depth, moves it to that position of the empty cells array and
+ * computes it's candidates.
+ *
+ * Without COUNT_MRV this is simply the next empty cell in the board (the same order num_solutions uses).
+ * With COUNT_MRV this is the cell with the fewest candidates, as it's the one most likely to fail (or be forced).
+ * Ties are broken by degree- the number of empty cells in the cell's row, column and block, as filling that cell
+ * constrains the most other cells.
+ */
+void choose(bitSearch* s, int depth){
+	int j, best = depth, num, bestNum = s->dim + 1, deg, bestDeg = -1, tmp;
+	bitmask cur, bestCand = 0;
+	if (!(s->flags & COUNT_MRV)){
+		s->cand[depth] = s->allowed[s->cellAt[depth]] & ~(s->rows[s->rowOf[depth]] | s->cols[s->colOf[depth]] | s->blocks[s->blockOf[depth]]);
+	}
+	else{
+		for (j = depth ; j < s->numEmpty ; j++){
+			cur = s->allowed[s->cellAt[j]] & ~(s->rows[s->rowOf[j]] | s->cols[s->colOf[j]] | s->blocks[s->blockOf[j]]);
+			num = bitNum(cur);
+			if (num > bestNum){
+				continue;
+			}
+			deg = s->freeRows[s->rowOf[j]] + s->freeCols[s->colOf[j]] + s->freeBlocks[s->blockOf[j]];
+			if (num < bestNum || deg > bestDeg){
+				best = j;
+				bestNum = num;
+				bestDeg = deg;
+				bestCand = cur;
+				if (num <= 1){ /*a dead end or a forced cell, no need to look any further*/
+					break;
+				}
+			}
+		}
+		/*swap the chosen cell into this depth's position*/
+		tmp = s->cellAt[depth]; s->cellAt[depth] = s->cellAt[best]; s->cellAt[best] = tmp;
+		tmp = s->rowOf[depth]; s->rowOf[depth] = s->rowOf[best]; s->rowOf[best] = tmp;
+		tmp = s->colOf[depth]; s->colOf[depth] = s->colOf[best]; s->colOf[best] = tmp;
+		tmp = s->blockOf[depth]; s->blockOf[depth] = s->blockOf[best]; s->blockOf[best] = tmp;
+		s->cand[depth] = bestCand;
+	}
+	if (s->flags & COUNT_LCV){
+		orderValues(s, depth);
+	}
+}
+
+/*
+ * Least constraining value: orders the candidates of the cell at depth by the number of empty peer cells (same row,
+ * column or block) that would lose that value as a candidate, fewest first.
+ */
+void orderValues(bitSearch* s, int depth){
+	int count[MAX_BIT_DIM], n = 0, i, j, p, peer, tmp, *peers = s->g->peers + s->cellAt[depth]*s->g->numPeers;
+	bitmask vals[MAX_BIT_DIM], m, bit, peerCand, tmpBit;
+	for (m = s->cand[depth] ; m != 0 ; m ^= bit){
+		bit = m & (~m + 1);
+		vals[n] = bit;
+		count[n] = 0;
+		n++;
+	}
+	for (p = 0 ; p < s->g->numPeers ; p++){
+		peer = peers[p];
+		if (s->cellVal[peer] != 0){
+			continue;
+		}
+		peerCand = s->allowed[peer] & ~(s->rows[s->g->rowOf[peer]] | s->cols[s->g->colOf[peer]] | s->blocks[s->g->blockOf[peer]]);
+		for (i = 0 ; i < n ; i++){
+			if (peerCand & vals[i]){
+				count[i]++;
+			}
+		}
+	}
+	for (i = 1 ; i < n ; i++){ /*insertion sort, there are at most dim values*/
+		for (j = i ; j > 0 && count[j-1] > count[j] ; j--){
+			tmp = count[j]; count[j] = count[j-1]; count[j-1] = tmp;
+			tmpBit = vals[j]; vals[j] = vals[j-1]; vals[j-1] = tmpBit;
+		}
+	}
+	for (i = 0 ; i < n ; i++){
+		s->order[depth*s->dim + i] = vals[i];
+	}
+	s->next[depth] = 0;
+}
+
+/*
+ * Places value bit in the cell at position depth and updates masks.
+ */
+void place(bitSearch* s, int depth, bitmask bit){
+	s->placed[depth] = bit;
+	s->rows[s->rowOf[depth]] |= bit;
+	s->cols[s->colOf[depth]] |= bit;
+	s->blocks[s->blockOf[depth]] |= bit;
+	if (s->memo != NULL){
+		toggleHash(s, depth, bit);
+	}
+	if (s->flags & (COUNT_MRV | COUNT_LCV)){ /*the bookkeeping below is only used by the heuristics*/
+		s->cellVal[s->cellAt[depth]] = bit;
+		s->freeRows[s->rowOf[depth]]--;
+		s->freeCols[s->colOf[depth]]--;
+		s->freeBlocks[s->blockOf[depth]]--;
+	}
+}
+
+/*
+ * Clears the value placed in the cell at position depth and updates masks.
+ */
+void removeVal(bitSearch* s, int depth){
+	bitmask bit = s->placed[depth];
+	s->rows[s->rowOf[depth]] ^= bit;
+	s->cols[s->colOf[depth]] ^= bit;
+	s->blocks[s->blockOf[depth]] ^= bit;
+	if (s->memo != NULL){
+		toggleHash(s, depth, bit);
+	}
+	if (s->flags & (COUNT_MRV | COUNT_LCV)){
+		s->cellVal[s->cellAt[depth]] = 0;
+		s->freeRows[s->rowOf[depth]]++;
+		s->freeCols[s->colOf[depth]]++;
+		s->freeBlocks[s->blockOf[depth]]++;
+	}
+}
+
+/*
+ * Returns number of values in mask m.
+ */
+int bitNum(bitmask m){
+#ifdef __GNUC__
+	return __builtin_popcountl(m);
+#else
+	int n = 0;
+	while (m){
+		m &= m - 1;
+		n++;
+	}
+	return n;
+#endif
+}
@@ -0,0 +1,75 @@
+/*
+ * bitSolver.h
+ *
+ *	Solution counting engine that keeps the occupancy of every row, column and block as a bitmask.
+ *	Bit (v-1) of a mask is set when value v already appears in that row / column / block, so the valid candidates of an
+ *	empty cell are the complement of the OR of it's three masks, and testing a candidate is a single AND
+ *	(instead of rescanning the row, column and block for every value like isValidm does).
+ *
+ *	The masks are updated as the search places and removes values, so the board array itself is never rescanned.
+ *
+ *  Created on: Jul 3, 2019
+ *      Author: Edanz
+ */
+
+#ifndef BITSOLVER_H_
+#define BITSOLVER_H_
+
+#include <limits.h>
+#include "bigNum.h"
+
+/*
+ * A set of values of a single row / column / block / cell. Bit (v-1) stands for value v.
+ */
+typedef unsigned long bitmask;
+
+/*
+ * Largest board dimension (blockw*blockh) that fits in a single bitmask.
+ */
+#define MAX_BIT_DIM ((int) (sizeof(bitmask) * CHAR_BIT))
+
+/*
+ * Search heuristics for bitCount, may be combined with |.
+ * COUNT_MRV - minimum remaining values: fill the cell with the fewest candidates first, ties broken by degree.
+ * COUNT_LCV - least constraining value: try first the values that remove the fewest candidates from empty peer cells.
+ * COUNT_MEMO - keep the counts of searched states in a transposition table (memo module), with the memory budget set in
+ * settings, and don't search a state again when it's reached through a different order of placements. Only used by
+ * counts with no limit.
+ * Without any flag, cells are filled in order and values tried from 1 up, like num_solutions does.
+ */
+#define COUNT_MRV 1
+#define COUNT_LCV 2
+#define COUNT_MEMO 4
+
+/*
+ * Counts number of solutions possible for current board and returns it (0 if none, -1 if it doesn't fit in an int).
+ * Returns exactly what num_solutions returns for the same board, but usually does so much faster.
+ *
+ * Receives board in 1d array form, block sizes and a combination of COUNT_* flags choosing the search heuristics.
+ * The array is not modified.
+ * Assumes legal board size and matching block sizes.
+ *
+ * Boards with more than MAX_BIT_DIM values are handed over to num_solutions.
+ */
+int bitCount(int* b, int blockW, int blockH, int flags);
+
+/*
+ * Same as bitCount, but adds the number of solutions found to count, and stops as soon as count reaches limit
+ * (searches exhaustively if limit <= 0).
+ * allowed is either NULL, or holds a mask for every cell of the board, and only values in it's cell's mask are tried for an
+ * empty cell (used to pass on candidates already ruled out, see propagate.h).
+ */
+void bitCountLimit(int* b, int blockW, int blockH, int flags, bitmask* allowed, int limit, bigNum* count);
+
+/*
+ * Returns number of values in mask m.
+ */
+int bitNum(bitmask m);
+
+/*
+ * Returns a well mixed 32 bit word made from x (the finalizer of MurmurHash3), the same in every run.
+ * Used for the hash words of the counter's transposition table and of the state cache.
+ */
+unsigned long mix32(unsigned long x);
+
+#endif /* BITSOLVER_H_ */
@@ -0,0 +1,97 @@
+/*
+ * candSet.c
+ *
+ *	Candidate sets of any number of words, see header.
+ *
+ *  Created on: Jul 18, 2019
+ *      Author: Edanz
+ */
+
+#include "candSet.h"
+
+/*
+ * Makes s the empty set (of words words).
+ */
+void candClear(bitmask* s, int words){
+	int w;
+	for (w = 0 ; w < words ; w++){
+		s[w] = 0;
+	}
+}
+
+/*
+ * Makes s the set of all values 1..dim. Only the last word may be partly full.
+ */
+void candFill(bitmask* s, int dim){
+	int w, words = CAND_WORDS(dim), rest = dim % MAX_BIT_DIM;
+	for (w = 0 ; w < words ; w++){
+		s[w] = ~((bitmask) 0);
+	}
+	if (rest != 0){
+		s[words - 1] = (((bitmask) 1) << rest) - 1;
+	}
+}
+
+/*
+ * Returns the number of values in s.
+ */
+int candCount(bitmask* s, int words){
+	int w, n = 0;
+	for (w = 0 ; w < words ; w++){
+		n += bitNum(s[w]);
+	}
+	return n;
+}
+
+/*
+ * Returns the smallest value of s bigger than val, or 0 if there is none.
+ * Value val+1 is bit val % MAX_BIT_DIM of word val / MAX_BIT_DIM, so the bits below it are masked off that word, and the
+ * words after it are taken as they are.
+ */
+int candNext(bitmask* s, int words, int val){
+	int w = val / MAX_BIT_DIM;
+	bitmask m;
+	if (w >= words){
+		return 0;
+	}
+	m = s[w] & (~((bitmask) 0) << (val % MAX_BIT_DIM));
+	while (m == 0){
+		w++;
+		if (w >= words){
+			return 0;
+		}
+		m = s[w];
+	}
+	return w*MAX_BIT_DIM + lowestBit(m) + 1;
+}
+
+/*
+ * Writes the values of s to out in increasing order, and returns their number.
+ */
+int candToArray(bitmask* s, int words, int* out){
+	int w, n = 0;
+	bitmask m;
+	for (w = 0 ; w < words ; w++){
+		for (m = s[w] ; m != 0 ; m &= m - 1){
+			out[n] = w*MAX_BIT_DIM + lowestBit(m) + 1;
+			n++;
+		}
+	}
+	return n;
+}
+
+/*
+ * Returns the index of the lowest set bit of m (0 based). Assumes m != 0.
+ */
+int lowestBit(bitmask m){
+#ifdef __GNUC__
+	return __builtin_ctzl(m);
+#else
+	int i = 0;
+	while (!(m & 1)){
+		m >>= 1;
+		i++;
+	}
+	return i;
+#endif
+}
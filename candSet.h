@@ -0,0 +1,74 @@
+/*
+ * candSet.h
+ *
+ *	Sets of cell values (candidates), for boards of any size.
+ *
+ *	A candidate set is an array of CAND_WORDS(dim) bitmasks, bit (v-1) % MAX_BIT_DIM of word (v-1) / MAX_BIT_DIM standing
+ *	for value v. Boards with up to MAX_BIT_DIM values (64 on most platforms) use a single word, so their sets cost no more
+ *	than a plain bitmask, bigger boards use as many words as needed. The caller owns the words, the functions below only
+ *	read and write them.
+ *
+ *  Created on: Jul 18, 2019
+ *      Author: Edanz
+ */
+
+#ifndef CANDSET_H_
+#define CANDSET_H_
+
+#include "bitSolver.h"
+
+/*
+ * Number of words in a candidate set of values 1..dim.
+ */
+#define CAND_WORDS(dim) (((dim) + MAX_BIT_DIM - 1) / MAX_BIT_DIM)
+
+/*
+ * Sets of up to CAND_LOCAL_WORDS words may be kept in local arrays, bigger ones are allocated.
+ */
+#define CAND_LOCAL_WORDS 4
+
+/*
+ * Word and bit of value val.
+ */
+#define CAND_WORD(val) (((val) - 1) / MAX_BIT_DIM)
+#define CAND_BIT(val) (((bitmask) 1) << (((val) - 1) % MAX_BIT_DIM))
+
+/*
+ * Adds value val to set s, removes it, or checks whether s holds it.
+ */
+#define candAdd(s, val) ((s)[CAND_WORD(val)] |= CAND_BIT(val))
+#define candRemove(s, val) ((s)[CAND_WORD(val)] &= ~CAND_BIT(val))
+#define candHas(s, val) (((s)[CAND_WORD(val)] & CAND_BIT(val)) != 0)
+
+/*
+ * Makes s the empty set (of words words).
+ */
+void candClear(bitmask* s, int words);
+
+/*
+ * Makes s the set of all values 1..dim.
+ */
+void candFill(bitmask* s, int dim);
+
+/*
+ * Returns the number of values in s.
+ */
+int candCount(bitmask* s, int words);
+
+/*
+ * Returns the smallest value of s bigger than val, or 0 if there is none.
+ * All the values of s are visited, in increasing order, by: for (v = candNext(s,words,0) ; v != 0 ; v = candNext(s,words,v))
+ */
+int candNext(bitmask* s, int words, int val);
+
+/*
+ * Writes the values of s to out in increasing order, and returns their number.
+ */
+int candToArray(bitmask* s, int words, int* out);
+
+/*
+ * Returns the index of the lowest set bit of m (0 based). Assumes m != 0.
+ */
+int lowestBit(bitmask m);
+
+#endif /* CANDSET_H_ */
@@ -0,0 +1,280 @@
+/*
+ * diskCache.c
+ *
+ *	On-disk solve cache, see header.
+ *
+ *	File layout (all numbers are big endian, so a file can be shared by any machines):
+ *		header: the 4 bytes "SDKC", a version byte and 3 unused bytes, the number of slots (4 bytes) and the time of the
+ *			last store (4 bytes, incremented by every store).
+ *		slots: a used byte, an unused byte, block width and block height bytes, the time the slot was written (4 bytes),
+ *			then DISK_MAX_CELLS bytes of board and DISK_MAX_CELLS bytes of solution.
+ *	The file is opened on every access rather than kept open, as closing a file drops all of the process' locks on it.
+ *
+ *  Created on: Jul 29, 2019
+ *      Author: Edanz
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "diskCache.h"
+#include "settings.h"
+
+#define DISK_VERSION 1
+#define DISK_HEADER 16
+#define DISK_SLOT (8 + 2*DISK_MAX_CELLS)
+
+static int broken = 0; /*1 once an error turned the cache off*/
+
+int openCache(int lockType);
+void closeCache(int fd);
+int initFile(int fd);
+int checkHeader(int fd);
+int encodeBoard(int* b, int blockW, int blockH, unsigned char* key);
+unsigned long hashKey(unsigned char* key, int len);
+int readAt(int fd, long pos, unsigned char* buf, int len);
+int writeAt(int fd, long pos, unsigned char* buf, int len);
+unsigned long getWord(unsigned char* p);
+void putWord(unsigned char* p, unsigned long val);
+
+/*
+ * Looks for board b (1d array form, not changed) in the cache file.
+ * Returns 1 and copies a solution of it to solution (at least the board size) if it's there, 0 if it isn't (or there
+ * is no cache).
+ */
+int diskFind(int* b, int blockW, int blockH, int* solution){
+	unsigned char key[4 + DISK_MAX_CELLS], slot[DISK_SLOT];
+	int fd, i, k, size = blockW*blockH*blockW*blockH, res = 0;
+	unsigned long home;
+	if (!encodeBoard(b, blockW, blockH, key) || (fd = openCache(F_RDLCK)) < 0){
+		return 0;
+	}
+	home = hashKey(key, 2 + size);
+	for (i = 0 ; i < DISK_WAYS ; i++){
+		if (!readAt(fd, DISK_HEADER + (long) ((home + i) % DISK_SLOTS)*DISK_SLOT, slot, DISK_SLOT)){
+			break;
+		}
+		if (!slot[0] || slot[2] != key[0] || slot[3] != key[1] || memcmp(slot + 8, key + 2, size) != 0){
+			continue;
+		}
+		res = 1;
+		for (k = 0 ; k < size ; k++){
+			solution[k] = slot[8 + DISK_MAX_CELLS + k];
+		}
+		break;
+	}
+	closeCache(fd);
+	return res;
+}
+
+/*
+ * Records solution as a solution of board b in the cache file.
+ * The board takes the slot already holding it, or else the first free slot of it's ways, or else the oldest one.
+ */
+void diskStore(int* b, int blockW, int blockH, int* solution){
+	unsigned char key[4 + DISK_MAX_CELLS], slot[DISK_SLOT], header[DISK_HEADER];
+	int fd, i, k, size = blockW*blockH*blockW*blockH, best = -1;
+	unsigned long home, now, bestTime = 0, t;
+	if (!encodeBoard(b, blockW, blockH, key) || (fd = openCache(F_WRLCK)) < 0){
+		return;
+	}
+	home = hashKey(key, 2 + size);
+	for (i = 0 ; i < DISK_WAYS ; i++){
+		if (!readAt(fd, DISK_HEADER + (long) ((home + i) % DISK_SLOTS)*DISK_SLOT, slot, DISK_SLOT)){
+			closeCache(fd);
+			return;
+		}
+		t = getWord(slot + 4);
+		if (!slot[0] || (slot[2] == key[0] && slot[3] == key[1] && memcmp(slot + 8, key + 2, size) == 0)){
+			best = i;
+			break;
+		}
+		if (best < 0 || t < bestTime){
+			best = i;
+			bestTime = t;
+		}
+	}
+	if (readAt(fd, 0, header, DISK_HEADER)){
+		now = (getWord(header + 12) + 1) & 0xFFFFFFFFUL;
+		putWord(header + 12, now);
+		memset(slot, 0, DISK_SLOT);
+		slot[0] = 1;
+		slot[2] = key[0];
+		slot[3] = key[1];
+		putWord(slot + 4, now);
+		memcpy(slot + 8, key + 2, size);
+		for (k = 0 ; k < size ; k++){
+			slot[8 + DISK_MAX_CELLS + k] = (unsigned char) solution[k];
+		}
+		if (!writeAt(fd, DISK_HEADER + (long) ((home + best) % DISK_SLOTS)*DISK_SLOT, slot, DISK_SLOT) ||
+				!writeAt(fd, 0, header, DISK_HEADER)){
+			broken = 1;
+		}
+	}
+	closeCache(fd);
+}
+
+/*
+ * Opens the cache file and locks all of it with lockType (F_RDLCK or F_WRLCK), waiting for other processes if needed.
+ * A missing or empty file is created (which takes the write lock even for a lookup).
+ * Returns the file descriptor, or -1 if there is no usable cache.
+ */
+int openCache(int lockType){
+	char* path = getSettings()->diskCache;
+	struct flock lock;
+	struct stat st;
+	int fd;
+	if (path == NULL || broken){
+		return -1;
+	}
+	if ((fd = open(path, O_RDWR | O_CREAT, 0666)) < 0){
+		broken = 1;
+		return -1;
+	}
+	lock.l_start = 0;
+	lock.l_len = 0; /*whole file*/
+	lock.l_whence = SEEK_SET;
+	lock.l_type = F_WRLCK;
+	if (fstat(fd, &st) != 0 || (st.st_size == 0 && (fcntl(fd, F_SETLKW, &lock) != 0 || !initFile(fd)))){
+		close(fd);
+		broken = 1;
+		return -1;
+	}
+	lock.l_type = lockType; /*changes the write lock taken above, if any*/
+	if (fcntl(fd, F_SETLKW, &lock) != 0 || !checkHeader(fd)){
+		close(fd);
+		broken = 1;
+		return -1;
+	}
+	return fd;
+}
+
+/*
+ * Unlocks and closes the cache file.
+ */
+void closeCache(int fd){
+	struct flock lock;
+	lock.l_start = 0;
+	lock.l_len = 0;
+	lock.l_whence = SEEK_SET;
+	lock.l_type = F_UNLCK;
+	fcntl(fd, F_SETLK, &lock);
+	close(fd);
+}
+
+/*
+ * Writes the header and empty slots of a new cache to fd (locked for writing), unless another process already did.
+ * Returns 1 on success, 0 otherwise.
+ */
+int initFile(int fd){
+	unsigned char header[DISK_HEADER], *empty;
+	long i;
+	if (readAt(fd, 0, header, DISK_HEADER)){ /*someone was faster*/
+		return 1;
+	}
+	memset(header, 0, DISK_HEADER);
+	memcpy(header, "SDKC", 4);
+	header[4] = DISK_VERSION;
+	putWord(header + 8, DISK_SLOTS);
+	if ((empty = (unsigned char*) calloc(DISK_SLOT, 1)) == NULL || !writeAt(fd, 0, header, DISK_HEADER)){
+		free(empty);
+		return 0;
+	}
+	for (i = 0 ; i < DISK_SLOTS ; i++){
+		if (!writeAt(fd, DISK_HEADER + i*DISK_SLOT, empty, DISK_SLOT)){
+			free(empty);
+			return 0;
+		}
+	}
+	free(empty);
+	return 1;
+}
+
+/*
+ * Returns 1 if fd (locked) holds a cache of this version, 0 otherwise (so a file that isn't a cache is never written).
+ */
+int checkHeader(int fd){
+	unsigned char header[DISK_HEADER];
+	return (readAt(fd, 0, header, DISK_HEADER) && memcmp(header, "SDKC", 4) == 0 && header[4] == DISK_VERSION &&
+			getWord(header + 8) == DISK_SLOTS);
+}
+
+/*
+ * Writes the canonical encoding of board b to key: block width, block height, then every cell's value.
+ * Returns 0 (and writes nothing) if the board doesn't fit in a slot.
+ */
+int encodeBoard(int* b, int blockW, int blockH, unsigned char* key){
+	int i, dim = blockW*blockH, size = dim*dim;
+	if (size > DISK_MAX_CELLS || dim > 255){
+		return 0;
+	}
+	key[0] = (unsigned char) blockW;
+	key[1] = (unsigned char) blockH;
+	for (i = 0 ; i < size ; i++){
+		key[2 + i] = (unsigned char) b[i];
+	}
+	return 1;
+}
+
+/*
+ * Returns the 32 bit FNV-1a hash of the len bytes of key.
+ */
+unsigned long hashKey(unsigned char* key, int len){
+	unsigned long h = 2166136261UL;
+	int i;
+	for (i = 0 ; i < len ; i++){
+		h = ((h ^ key[i])*16777619UL) & 0xFFFFFFFFUL;
+	}
+	return h;
+}
+
+/*
+ * Reads len bytes at position pos of fd to buf. Returns 1 if all of them were read, 0 otherwise.
+ */
+int readAt(int fd, long pos, unsigned char* buf, int len){
+	int n, done = 0;
+	if (lseek(fd, pos, SEEK_SET) != pos){
+		return 0;
+	}
+	while (done < len && (n = read(fd, buf + done, len - done)) > 0){
+		done += n;
+	}
+	return (done == len);
+}
+
+/*
+ * Writes the len bytes of buf at position pos of fd. Returns 1 if all of them were written, 0 otherwise.
+ */
+int writeAt(int fd, long pos, unsigned char* buf, int len){
+	int n, done = 0;
+	if (lseek(fd, pos, SEEK_SET) != pos){
+		return 0;
+	}
+	while (done < len && (n = write(fd, buf + done, len - done)) > 0){
+		done += n;
+	}
+	return (done == len);
+}
+
+/*
+ * Returns the 4 byte big endian number at p.
+ */
+unsigned long getWord(unsigned char* p){
+	return ((unsigned long) p[0] << 24) | ((unsigned long) p[1] << 16) | ((unsigned long) p[2] << 8) | p[3];
+}
+
+/*
+ * Writes val as a 4 byte big endian number at p.
+ */
+void putWord(unsigned char* p, unsigned long val){
+	p[0] = (unsigned char) ((val >> 24) & 0xFF);
+	p[1] = (unsigned char) ((val >> 16) & 0xFF);
+	p[2] = (unsigned char) ((val >> 8) & 0xFF);
+	p[3] = (unsigned char) (val & 0xFF);
+}
@@ -0,0 +1,43 @@
+/*
+ * diskCache.h
+ *
+ *	Optional solve cache kept in a file, so boards solved by earlier runs (or by other processes running at the same time)
+ *	aren't solved again. It's used only when SUDOKU_DISK_CACHE names a file (see settings.h), created on first use.
+ *
+ *	The file is a hash table of DISK_SLOTS fixed size slots after a short header. A slot holds a solvable board in it's
+ *	canonical encoding (block sizes and one byte per cell) and one of it's solutions. A board is looked for
+ *	in DISK_WAYS slots starting at the slot it's hash picks, and compared in full, so a hit is never wrong. When all of
+ *	them are taken, the one written longest ago is replaced.
+ *	Only boards of up to DISK_MAX_CELLS cells and values of up to 255 fit in a slot, larger boards are never cached.
+ *
+ *	Boards found unsolvable aren't stored: a failed engine (such as GUROBI without a license) looks the same as an
+ *	unsolvable board, and the file outlives the failure.
+ *
+ *	Several processes may use the same file at once: every lookup holds a shared lock on the file, and every store an
+ *	exclusive one (POSIX record locks), so a slot is never read while half written. Any error (the file can't be opened,
+ *	locked or read, or isn't a cache file) turns the cache off for the rest of the run, and the board is simply solved.
+ *
+ *  Created on: Jul 29, 2019
+ *      Author: Edanz
+ */
+
+#ifndef DISKCACHE_H_
+#define DISKCACHE_H_
+
+#define DISK_SLOTS 1024
+#define DISK_WAYS 8
+#define DISK_MAX_CELLS 625 /*25x25 boards*/
+
+/*
+ * Looks for board b (1d array form, not changed) in the cache file.
+ * Returns 1 and copies a solution of it to solution (at least the board size) if it's there, 0 if it isn't (or there
+ * is no cache).
+ */
+int diskFind(int* b, int blockW, int blockH, int* solution);
+
+/*
+ * Records solution as a solution of board b in the cache file.
+ */
+void diskStore(int* b, int blockW, int blockH, int* solution);
+
+#endif /* DISKCACHE_H_ */
@@ -66,7 +66,7 @@ void dispatch(board **b,int cmd[],mode *m,char *name,int *finish,int *mark){
 			break;
 		}
 		case 12:{/*num solutions*/
-			handleNum(*b);
+			handleNum(*b,cmd[1]);
 			break;
 		}
 		case 13:{/*Autofill*/
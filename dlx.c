@@ -0,0 +1,356 @@
+/*
+ * dlx.c
+ *
+ *	Dancing Links implementation of Algorithm X. See header for the exact cover encoding of the board.
+ *
+ *	The sparse matrix is kept in parallel int arrays (left, right, up, down, column), node 0 is the root,
+ *	nodes 1..numCols are the column headers and the rest are the 1's of the matrix, four per row.
+ *	Covering a column unlinks it from the header list and unlinks every row that intersects it from the other columns,
+ *	uncovering does the exact opposite in reverse order, so the matrix is restored without any memory actions.
+ *
+ *	Like num_solutions, the search is pseudo recursive: choice[level] holds the row currently selected at every level,
+ *	which is all we need to undo the covering when backtracking.
+ *
+ *  Created on: Jul 8, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "solver.h"
+#include "dlx.h"
+#include "geometry.h"
+
+typedef struct S_dlx{
+	int *left, *right, *up, *down, *col; /*links of every node, col is the column header of the node*/
+	int *colSize; /*number of rows currently in every column*/
+	int *rowCell, *rowVal; /*cell and value represented by the matrix row of every node*/
+	int numCols;
+	int numNodes;
+} dlx;
+
+typedef struct S_solCopy{
+	int* out;
+	int size;
+} solCopy;
+
+int dlxRun(int* b, int blockW, int blockH, int* start, int limit, solVisitor visit, void* data, bigNum* found, volatile int* stop);
+int buildMatrix(dlx* d, int* b, int blockW, int blockH, int* start);
+void destroyMatrix(dlx* d);
+void addNode(dlx* d, int colHead);
+void moveToTop(dlx* d, int n);
+void cover(dlx* d, int c);
+void uncover(dlx* d, int c);
+int smallestCol(dlx* d);
+void copyVisitor(int* sol, void* data);
+
+/*
+ * Finds solutions to board b, calling visit on each one of them (visit may be NULL), and returns the number of solutions
+ * found (-1 if it doesn't fit in an int).
+ * Stops after limit solutions were found, or searches exhaustively if limit <= 0.
+ */
+int dlxEnumerate(int* b, int blockW, int blockH, int limit, solVisitor visit, void* data){
+	bigNum found;
+	bigSet(&found, 0);
+	dlxSearch(b, blockW, blockH, limit, visit, data, &found);
+	return bigToInt(&found);
+}
+
+/*
+ * Same as dlxEnumerate, but adds the number of solutions found to found instead of returning it.
+ * Stops as soon as found reaches limit (searches exhaustively if limit <= 0).
+ *
+ * Algorithm X:
+ * 		if no columns are left, the rows chosen so far are a solution.
+ * 		otherwise choose the column with fewest rows, cover it, and try each of it's rows in turn:
+ * 			select the row, cover every other column it intersects and go one level deeper.
+ * 		when all rows of a column were tried- uncover it and backtrack to the previous level.
+ */
+void dlxSearch(int* b, int blockW, int blockH, int limit, solVisitor visit, void* data, bigNum* found){
+	dlxRun(b, blockW, blockH, NULL, limit, visit, data, found, NULL);
+}
+
+/*
+ * The search of dlxSearch. stop is either NULL, or a flag that ends the search once it's set (checked on every level
+ * reached). Returns 1 if the search was stopped this way, 0 otherwise.
+ * start is either NULL or a full board whose rows are tried first in every column (see buildMatrix).
+ */
+int dlxRun(int* b, int blockW, int blockH, int* start, int limit, solVisitor visit, void* data, bigNum* found, volatile int* stop){
+	dlx d;
+	int level = 0, c, r, j, size = blockW*blockH*blockW*blockH, *choice, *sol, descend = 1, stopped = 0;
+	if (!buildMatrix(&d, b, blockW, blockH, start)){ /*some constraint can't be satisfied at all*/
+		return 0;
+	}
+	assert((choice = (int*) malloc((size+1)*sizeof(int)))!=NULL && "Memory allocation error");
+	assert((sol = (int*) malloc(size*sizeof(int)))!=NULL && "Memory allocation error");
+	while (level >= 0){
+		if (stop != NULL && *stop){
+			stopped = 1;
+			break;
+		}
+		if (descend){ /*reached a new level*/
+			if (d.right[0] == 0){ /*all constraints are covered*/
+				bigInc(found);
+				if (visit != NULL){
+					memcpy(sol, b, size*sizeof(int));
+					for (j = 0 ; j < level ; j++){
+						sol[d.rowCell[choice[j]]] = d.rowVal[choice[j]];
+					}
+					visit(sol, data);
+				}
+				if (limit > 0 && bigAtLeast(found, limit)){
+					break;
+				}
+				descend = 0;
+				level--;
+				continue;
+			}
+			c = smallestCol(&d);
+			cover(&d, c);
+			r = d.down[c]; /*first row of this column*/
+		}
+		else{ /*came back to this level, undo the row selected here and move on to the next one*/
+			r = choice[level];
+			for (j = d.left[r] ; j != r ; j = d.left[j]){
+				uncover(&d, d.col[j]);
+			}
+			c = d.col[r];
+			r = d.down[r];
+		}
+		if (r == c){ /*tried all rows of this column*/
+			uncover(&d, c);
+			descend = 0;
+			level--;
+			continue;
+		}
+		choice[level] = r;
+		for (j = d.right[r] ; j != r ; j = d.right[j]){
+			cover(&d, d.col[j]);
+		}
+		level++;
+		descend = 1;
+	}
+	free(choice);
+	free(sol);
+	destroyMatrix(&d);
+	return stopped;
+}
+
+/*
+ * Returns number of different possible solutions for board b (0 if none, -1 if it doesn't fit in an int).
+ */
+int dlxCount(int* b, int blockW, int blockH){
+	return dlxEnumerate(b, blockW, blockH, 0, NULL, NULL);
+}
+
+/*
+ * Returns 1 if board b is solvable and fills it with a solution, returns 0 (and leaves b unchanged) otherwise, or -1 if
+ * stopped by stop (see header).
+ */
+int dlxSolve(int* b, int blockW, int blockH, int* start, volatile int* stop){
+	solCopy copy;
+	bigNum found;
+	copy.out = b;
+	copy.size = blockW*blockH*blockW*blockH;
+	bigSet(&found, 0);
+	if (dlxRun(b, blockW, blockH, start, 1, copyVisitor, &copy, &found, stop)){
+		return -1;
+	}
+	return bigAtLeast(&found, 1);
+}
+
+/*
+ * Visitor used by dlxSolve, copies the solution to the board held in data.
+ */
+void copyVisitor(int* sol, void* data){
+	solCopy* copy = (solCopy*) data;
+	memcpy(copy->out, sol, copy->size*sizeof(int));
+}
+
+/*
+ * Builds the exact cover matrix of board b into d.
+ *
+ * Constraint k of family f (cell, row-value, column-value, block-value) is numbered f*size + k, and only gets a column
+ * if it is not satisfied by the board already.
+ * Returns 0 if some constraint is left without any row that can satisfy it (so the board has no solution).
+ * If start is not NULL, the rows placing the values of start are moved to the top of their columns, so the search tries
+ * them before any other row and walks straight to start where it agrees with b.
+ */
+int buildMatrix(dlx* d, int* b, int blockW, int blockH, int* start){
+	int dim = blockW*blockH, size = dim*dim, i, v, r, c, k, f, first, numRows = 0, *colId, *used, cons[4];
+	geometry* g = getGeometry(blockW, blockH);
+	assert((colId = (int*) malloc(4*size*sizeof(int)))!=NULL && "Memory allocation error");
+	assert((used = (int*) calloc(4*size, sizeof(int)))!=NULL && "Memory allocation error");
+	/*mark satisfied constraints, used[f*size + k] is 1 if constraint k of family f is already satisfied*/
+	for (i = 0 ; i < size ; i++){
+		if (b[i] == 0){
+			continue;
+		}
+		r = g->rowOf[i];
+		c = g->colOf[i];
+		k = g->blockOf[i];
+		used[i] = 1;
+		used[size + r*dim + b[i] - 1] = 1;
+		used[2*size + c*dim + b[i] - 1] = 1;
+		used[3*size + k*dim + b[i] - 1] = 1;
+	}
+	/*count rows, so the node arrays can be allocated once*/
+	for (i = 0 ; i < size ; i++){
+		if (b[i] != 0){
+			continue;
+		}
+		r = g->rowOf[i];
+		c = g->colOf[i];
+		k = g->blockOf[i];
+		for (v = 0 ; v < dim ; v++){
+			if (!used[size + r*dim + v] && !used[2*size + c*dim + v] && !used[3*size + k*dim + v]){
+				numRows++;
+			}
+		}
+	}
+	d->numCols = 0;
+	for (i = 0 ; i < 4*size ; i++){
+		colId[i] = used[i] ? -1 : ++(d->numCols); /*headers are nodes 1..numCols*/
+	}
+	assert((d->left = (int*) malloc(5*(1 + d->numCols + 4*numRows)*sizeof(int)))!=NULL && "Memory allocation error");
+	d->right = d->left + 1 + d->numCols + 4*numRows;
+	d->up = d->right + 1 + d->numCols + 4*numRows;
+	d->down = d->up + 1 + d->numCols + 4*numRows;
+	d->col = d->down + 1 + d->numCols + 4*numRows;
+	assert((d->colSize = (int*) calloc(1 + d->numCols, sizeof(int)))!=NULL && "Memory allocation error");
+	assert((d->rowCell = (int*) malloc(2*(1 + d->numCols + 4*numRows)*sizeof(int)))!=NULL && "Memory allocation error");
+	d->rowVal = d->rowCell + 1 + d->numCols + 4*numRows;
+	/*root and column headers form a circular list*/
+	for (i = 0 ; i <= d->numCols ; i++){
+		d->left[i] = (i == 0) ? d->numCols : i - 1;
+		d->right[i] = (i == d->numCols) ? 0 : i + 1;
+		d->up[i] = i;
+		d->down[i] = i;
+		d->col[i] = i;
+	}
+	d->numNodes = 1 + d->numCols;
+	/*rows*/
+	for (i = 0 ; i < size ; i++){
+		if (b[i] != 0){
+			continue;
+		}
+		r = g->rowOf[i];
+		c = g->colOf[i];
+		k = g->blockOf[i];
+		for (v = 0 ; v < dim ; v++){
+			cons[0] = i;
+			cons[1] = size + r*dim + v;
+			cons[2] = 2*size + c*dim + v;
+			cons[3] = 3*size + k*dim + v;
+			if (used[cons[1]] || used[cons[2]] || used[cons[3]]){ /*value already appears in row, column or block*/
+				continue;
+			}
+			first = d->numNodes;
+			for (f = 0 ; f < 4 ; f++){
+				addNode(d, colId[cons[f]]);
+				d->left[first + f] = first + ((f + 3) % 4);
+				d->right[first + f] = first + ((f + 1) % 4);
+			}
+			for (f = 0 ; f < 4 ; f++){ /*any node of the row may be the one selected in the search*/
+				d->rowCell[first + f] = i;
+				d->rowVal[first + f] = v + 1;
+			}
+			for (f = 0 ; start != NULL && start[i] == v + 1 && f < 4 ; f++){
+				moveToTop(d, first + f);
+			}
+		}
+	}
+	free(colId);
+	free(used);
+	for (i = 1 ; i <= d->numCols ; i++){
+		if (d->colSize[i] == 0){
+			destroyMatrix(d);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * frees all space allocated to the matrix.
+ */
+void destroyMatrix(dlx* d){
+	free(d->left);
+	free(d->colSize);
+	free(d->rowCell);
+}
+
+/*
+ * Appends a new node at the bottom of column colHead. Horizontal links are set by the caller.
+ */
+void addNode(dlx* d, int colHead){
+	int n = d->numNodes;
+	d->col[n] = colHead;
+	d->up[n] = d->up[colHead];
+	d->down[n] = colHead;
+	d->down[d->up[colHead]] = n;
+	d->up[colHead] = n;
+	d->colSize[colHead]++;
+	d->numNodes++;
+}
+
+/*
+ * Moves node n from the bottom of it's column (where addNode put it) to the top.
+ */
+void moveToTop(dlx* d, int n){
+	int c = d->col[n];
+	d->down[d->up[n]] = d->down[n];
+	d->up[d->down[n]] = d->up[n];
+	d->up[n] = c;
+	d->down[n] = d->down[c];
+	d->up[d->down[c]] = n;
+	d->down[c] = n;
+}
+
+/*
+ * Removes column c from the header list, and every row intersecting it from all other columns.
+ */
+void cover(dlx* d, int c){
+	int i, j;
+	d->right[d->left[c]] = d->right[c];
+	d->left[d->right[c]] = d->left[c];
+	for (i = d->down[c] ; i != c ; i = d->down[i]){
+		for (j = d->right[i] ; j != i ; j = d->right[j]){
+			d->down[d->up[j]] = d->down[j];
+			d->up[d->down[j]] = d->up[j];
+			d->colSize[d->col[j]]--;
+		}
+	}
+}
+
+/*
+ * Exact reverse of cover.
+ */
+void uncover(dlx* d, int c){
+	int i, j;
+	for (i = d->up[c] ; i != c ; i = d->up[i]){
+		for (j = d->left[i] ; j != i ; j = d->left[j]){
+			d->colSize[d->col[j]]++;
+			d->down[d->up[j]] = j;
+			d->up[d->down[j]] = j;
+		}
+	}
+	d->right[d->left[c]] = c;
+	d->left[d->right[c]] = c;
+}
+
+/*
+ * Returns the uncovered column with the fewest rows (Knuth's S heuristic).
+ */
+int smallestCol(dlx* d){
+	int c, best = d->right[0], min = d->colSize[best];
+	for (c = d->right[best] ; c != 0 && min > 1 ; c = d->right[c]){
+		if (d->colSize[c] < min){
+			min = d->colSize[c];
+			best = c;
+		}
+	}
+	return best;
+}
@@ -0,0 +1,62 @@
+/*
+ * dlx.h
+ *
+ *	Solves and counts Sudoku boards with Knuth's Algorithm X, implemented with Dancing Links (DLX).
+ *
+ *	The board is encoded as an exact cover problem: there is a row for every (empty cell, valid value) pair, and a column
+ *	for every constraint that is not already satisfied by the board's filled cells. Constraints come in four families:
+ *		- cell: every cell holds exactly one value.
+ *		- row-value: every value appears exactly once in every row.
+ *		- column-value: every value appears exactly once in every column.
+ *		- block-value: every value appears exactly once in every block.
+ *	Each matrix row covers exactly one constraint of each family, and a solution to the board is a set of rows covering
+ *	every column exactly once.
+ *
+ *  Created on: Jul 8, 2019
+ *      Author: Edanz
+ */
+
+#ifndef DLX_H_
+#define DLX_H_
+
+#include "bigNum.h"
+
+/*
+ * Called by dlxEnumerate for every solution found.
+ * Receives the solved board as a 1d array (only valid during the call) and the data pointer passed to dlxEnumerate.
+ */
+typedef void (*solVisitor)(int* sol, void* data);
+
+/*
+ * Finds solutions to board b, calling visit on each one of them (visit may be NULL), and returns the number of solutions
+ * found (-1 if it doesn't fit in an int).
+ * Stops after limit solutions were found, or searches exhaustively if limit <= 0.
+ *
+ * Receives board in 1d array form (as returned by toArray) and block sizes. The array is not modified.
+ * Assumes legal board size and matching block sizes. Values already on the board are trusted, and are not checked
+ * against each other (same as num_solutions).
+ */
+int dlxEnumerate(int* b, int blockW, int blockH, int limit, solVisitor visit, void* data);
+
+/*
+ * Same as dlxEnumerate, but adds the number of solutions found to found (which is wide enough not to overflow on near
+ * empty boards) instead of returning it. Stops as soon as found reaches limit (searches exhaustively if limit <= 0).
+ */
+void dlxSearch(int* b, int blockW, int blockH, int limit, solVisitor visit, void* data, bigNum* found);
+
+/*
+ * Returns number of different possible solutions for board b (0 if none, -1 if it doesn't fit in an int).
+ * Same arguments and assumptions as dlxEnumerate.
+ */
+int dlxCount(int* b, int blockW, int blockH);
+
+/*
+ * Returns 1 if board b is solvable and fills it with a solution, returns 0 (and leaves b unchanged) otherwise.
+ * Same arguments and assumptions as dlxEnumerate.
+ * stop is either NULL, or a flag that makes the search give up once it's set (by another thread), in which case -1 is
+ * returned and b is left unchanged.
+ * start is either NULL, or a full board (that doesn't have to agree with b) whose values are tried first in every cell.
+ */
+int dlxSolve(int* b, int blockW, int blockH, int* start, volatile int* stop);
+
+#endif /* DLX_H_ */
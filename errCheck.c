@@ -0,0 +1,194 @@
+/*
+ * errCheck.c
+ *
+ *	Histogram based board validation. See header for the general idea.
+ *
+ *	The histograms are kept in a single int array, dup[u*(dim+1) + v] counting value v in unit u (units numbered as in
+ *	geometry.h, slot 0 is never used). The duplicate pass turns every count into -1 (more than once) or 0, which also tells
+ *	whether the board has any error at all. The marking pass looks up the three units of every cell; with AVX2 the lookups
+ *	of 8 cells are done by a single gather.
+ *
+ *	The vector kernels are compiled with gcc's target attribute, so the rest of the program is built for any x86 cpu, and
+ *	are only called after checking the cpu supports them.
+ *
+ *  Created on: Jul 17, 2019
+ *      Author: Edanz
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "errCheck.h"
+#include "geometry.h"
+#include "settings.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X86_KERNELS
+#include <immintrin.h>
+#endif
+
+int kernelLevel(void);
+int dupScalar(int* dup, int from, int n);
+int markScalar(int* b, geometry* g, int* dup, int* err, int from);
+#ifdef X86_KERNELS
+int dupSse2(int* dup, int n);
+int dupAvx2(int* dup, int n);
+int markAvx2(int* b, geometry* g, int* dup, int* err);
+#endif
+
+/*
+ * Finds the erroneous cells of board b, and returns their number (see header).
+ */
+int findErrors(int* b, int blockW, int blockH, int* err){
+	geometry* g = getGeometry(blockW, blockH);
+	int dim = g->dim, stride = dim + 1, n = 3*dim*(dim + 1), level = kernelLevel(), i, v, any, count;
+	int* dup;
+	assert((dup = (int*) calloc(n, sizeof(int)))!=NULL && "Memory allocation error");
+	for (i = 0 ; i < g->size ; i++){
+		v = b[i];
+		if (v > 0 && v <= dim){
+			dup[g->rowOf[i]*stride + v]++;
+			dup[(dim + g->colOf[i])*stride + v]++;
+			dup[(2*dim + g->blockOf[i])*stride + v]++;
+		}
+	}
+#ifdef X86_KERNELS
+	if (level == simdAvx2){
+		any = dupAvx2(dup, n);
+	}
+	else if (level == simdSse2){
+		any = dupSse2(dup, n);
+	}
+	else{
+		any = dupScalar(dup, 0, n);
+	}
+#else
+	any = dupScalar(dup, 0, n);
+#endif
+	if (!any || err == NULL){ /*nothing left to find*/
+		if (err != NULL){
+			memset(err, 0, g->size*sizeof(int));
+		}
+		free(dup);
+		return any;
+	}
+#ifdef X86_KERNELS
+	count = (level == simdAvx2) ? markAvx2(b, g, dup, err) : markScalar(b, g, dup, err, 0);
+#else
+	count = markScalar(b, g, dup, err, 0);
+#endif
+	free(dup);
+	return count;
+}
+
+/*
+ * Returns the widest kernel to use: the one chosen in the settings, if the cpu supports it.
+ * The cpu is only checked on first call.
+ */
+int kernelLevel(void){
+	static int supported = -1;
+	int want = getSettings()->simd;
+	if (supported < 0){
+		supported = simdScalar;
+#ifdef X86_KERNELS
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("sse2")){
+			supported = simdSse2;
+		}
+		if (__builtin_cpu_supports("avx2")){
+			supported = simdAvx2;
+		}
+#endif
+	}
+	return (want < supported) ? want : supported;
+}
+
+/*
+ * Duplicate pass over dup[from..n): replaces every count with -1 if it's more than 1, 0 otherwise.
+ * Returns 1 if some count was more than 1, 0 otherwise.
+ */
+int dupScalar(int* dup, int from, int n){
+	int i, any = 0;
+	for (i = from ; i < n ; i++){
+		dup[i] = (dup[i] > 1) ? -1 : 0;
+		any |= dup[i];
+	}
+	return (any != 0);
+}
+
+/*
+ * Marking pass over cells from..size-1 of the board: sets err[i] to 1 if the value of cell i is flagged in one of it's
+ * units, 0 otherwise. Returns the number of cells marked.
+ */
+int markScalar(int* b, geometry* g, int* dup, int* err, int from){
+	int dim = g->dim, stride = dim + 1, i, v, count = 0;
+	for (i = from ; i < g->size ; i++){
+		v = b[i];
+		err[i] = (v > 0 && v <= dim && (dup[g->rowOf[i]*stride + v] | dup[(dim + g->colOf[i])*stride + v] |
+				dup[(2*dim + g->blockOf[i])*stride + v]) != 0);
+		count += err[i];
+	}
+	return count;
+}
+
+#ifdef X86_KERNELS
+
+/*
+ * Same as dupScalar over the whole array, 4 counts at a time.
+ */
+__attribute__((target("sse2")))
+int dupSse2(int* dup, int n){
+	int i, last = n - n % 4;
+	__m128i one = _mm_set1_epi32(1), any = _mm_setzero_si128(), x;
+	for (i = 0 ; i < last ; i += 4){
+		x = _mm_cmpgt_epi32(_mm_loadu_si128((__m128i*) (dup + i)), one);
+		_mm_storeu_si128((__m128i*) (dup + i), x);
+		any = _mm_or_si128(any, x);
+	}
+	return (dupScalar(dup, last, n) || _mm_movemask_epi8(any) != 0);
+}
+
+/*
+ * Same as dupScalar over the whole array, 8 counts at a time.
+ */
+__attribute__((target("avx2")))
+int dupAvx2(int* dup, int n){
+	int i, last = n - n % 8;
+	__m256i one = _mm256_set1_epi32(1), any = _mm256_setzero_si256(), x;
+	for (i = 0 ; i < last ; i += 8){
+		x = _mm256_cmpgt_epi32(_mm256_loadu_si256((__m256i*) (dup + i)), one);
+		_mm256_storeu_si256((__m256i*) (dup + i), x);
+		any = _mm256_or_si256(any, x);
+	}
+	return (dupScalar(dup, last, n) || !_mm256_testz_si256(any, any));
+}
+
+/*
+ * Same as markScalar over the whole board, 8 cells at a time: the flags of the cells' row, column and block are gathered
+ * (only for lanes holding a legal value) and or'ed together. The last size % 8 cells are left to markScalar.
+ */
+__attribute__((target("avx2")))
+int markAvx2(int* b, geometry* g, int* dup, int* err){
+	int dim = g->dim, i, last = g->size - g->size % 8, sums[8], count;
+	__m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi32(1), stride = _mm256_set1_epi32(dim + 1);
+	__m256i colBase = _mm256_set1_epi32(dim*(dim + 1)), blockBase = _mm256_set1_epi32(2*dim*(dim + 1));
+	__m256i limit = _mm256_set1_epi32(dim + 1), total = _mm256_setzero_si256(), v, legal, idx, e;
+	for (i = 0 ; i < last ; i += 8){
+		v = _mm256_loadu_si256((__m256i*) (b + i));
+		legal = _mm256_and_si256(_mm256_cmpgt_epi32(v, zero), _mm256_cmpgt_epi32(limit, v));
+		idx = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_loadu_si256((__m256i*) (g->rowOf + i)), stride), v);
+		e = _mm256_mask_i32gather_epi32(zero, dup, idx, legal, 4);
+		idx = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_loadu_si256((__m256i*) (g->colOf + i)), stride), v);
+		e = _mm256_or_si256(e, _mm256_mask_i32gather_epi32(zero, dup, _mm256_add_epi32(idx, colBase), legal, 4));
+		idx = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_loadu_si256((__m256i*) (g->blockOf + i)), stride), v);
+		e = _mm256_or_si256(e, _mm256_mask_i32gather_epi32(zero, dup, _mm256_add_epi32(idx, blockBase), legal, 4));
+		e = _mm256_and_si256(e, one);
+		_mm256_storeu_si256((__m256i*) (err + i), e);
+		total = _mm256_add_epi32(total, e);
+	}
+	_mm256_storeu_si256((__m256i*) sums, total);
+	count = sums[0] + sums[1] + sums[2] + sums[3] + sums[4] + sums[5] + sums[6] + sums[7];
+	return count + markScalar(b, g, dup, err, last);
+}
+
+#endif
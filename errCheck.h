@@ -0,0 +1,29 @@
+/*
+ * errCheck.h
+ *
+ *	Finds all erroneous cells of a board at once (a cell is erroneous if it's value appears again in it's row, column or
+ *	block), in time linear in the board size instead of checking every cell against all of it's peers.
+ *
+ *	The board is scanned once to build a histogram of the values of every unit (row, column and block). Every unit value
+ *	counted more than once is turned into a "duplicate" flag, and a cell is erroneous if it's value is flagged in any of
+ *	it's three units. The last two passes are vectorized with SSE2 / AVX2 where the cpu supports them (checked at run time),
+ *	with a plain C fallback. The widest kernel used can be lowered with SUDOKU_SIMD (see settings.h).
+ *
+ *  Created on: Jul 17, 2019
+ *      Author: Edanz
+ */
+
+#ifndef ERRCHECK_H_
+#define ERRCHECK_H_
+
+/*
+ * Finds the erroneous cells of board b, and returns their number.
+ * Sets err[i] to 1 if cell i is erroneous and to 0 otherwise (empty cells are never erroneous).
+ * If err is NULL, only checks whether the board has errors: returns 0 if it doesn't and a positive number otherwise.
+ *
+ * Receives board in 1d array form (not modified) and block sizes. Assumes legal board size and matching block sizes.
+ * Values outside 1..dim are treated as empty.
+ */
+int findErrors(int* b, int blockW, int blockH, int* err);
+
+#endif /* ERRCHECK_H_ */
@@ -17,12 +17,15 @@
 #include "history.h"
 #include "mode.h"
 #include "solver.h"
+#include "errCheck.h"
+#include "stateCache.h"
 
 int getMaxVal(board* b);
 void simpleSet(board* b, int val, int index);
 void markAll(board* b);
 int cordToInd(board *b, int cord[2]);
-void markErr(board* b, int i, int j);
+void markErr(board* b, int index);
+void markUnit(board* b, int u);
 
 /*
  * Creates a new board from supplied array and dimensions.
@@ -44,6 +47,10 @@ board* createBoard(int* arr, int blockw, int blockh, mode m){
 	b->free = b->size;
 	b->nerr = 0;
 	b->solvable = 0;
+	b->hash[0] = 0;
+	b->hash[1] = 0;
+	b->solution = NULL;
+	b->lastSolution = NULL;
 	createHistory(&(b->hist));
 	assert((b->puzzle = (cell*) calloc(b->size , sizeof(cell)))!=NULL && "Memory allocation error");
 	assert((b->values = (int*) calloc(b->size , sizeof(int)))!=NULL && "Memory allocation error");
@@ -55,6 +62,8 @@ board* createBoard(int* arr, int blockw, int blockh, mode m){
 		if (arr[i]!=0){
 			b->free--;
 		}
+		b->hash[0] ^= cellHash(i, b->values[i], 0);
+		b->hash[1] ^= cellHash(i, b->values[i], 1);
 	}
 	markAll(b); /*check all cells in the board if they are erroneous and up date the structure accordingly*/
 	return b;
@@ -67,6 +76,8 @@ void destoryBoard(board* b){
 	}
 	free(b->puzzle);
 	free(b->values);
+	free(b->solution);
+	free(b->lastSolution);
 	clearHistory(&(b->hist));
 	free(b);
 }
@@ -118,17 +129,22 @@ void set(board* b, int arr[]){
  * used for applying moves from history, multiple board updates etc.
  */
 void simpleSet(board* b, int val, int index){
-	int max;
-	max = getMaxVal(b);
 	if ((val) && (!(b->values[index]))){ /*z is not zero*/
 		(b->free)--;
 	}
 	if ((b->values[index]) && !(val)){ /*we deleted the value in this cell*/
 		(b->free)++;
 	}
+	b->hash[0] ^= cellHash(index, b->values[index], 0) ^ cellHash(index, val, 0); /*swap the old value's words for the new one's*/
+	b->hash[1] ^= cellHash(index, b->values[index], 1) ^ cellHash(index, val, 1);
 	(b->values[index]) = val;
-	b->solvable = 0;
-	markErr(b,(index/max),(index % max)); /*update all changes in validity of neighboring cells due to this placement*/
+	if (b->solution != NULL && val && b->solution[index] != val){ /*the attached solution isn't a solution anymore*/
+		free(b->lastSolution);
+		b->lastSolution = b->solution; /*but most of it still fits, a good place to start the next solve*/
+		b->solution = NULL;
+	}
+	b->solvable = (b->solution != NULL); /*the board still agrees with a solution, so it's still solvable*/
+	markErr(b,index); /*update all changes in validity of neighboring cells due to this placement*/
 }
 
 /*
@@ -239,6 +255,7 @@ int isEmpty(board* b){
 
 /*
  * Returns 1 if board was validated since last change and found solvable, -1 if found unsolvable, 0 if a change was made.
+ * Changes that keep the attached solution keep the board solvable (see simpleSet).
  */
 int isSolvable(board* b){
 	return (b->solvable);
@@ -259,6 +276,40 @@ void setSolvable(board* b, int x){
 	}
 }
 
+/*
+ * Attaches a copy of sol, a solution of the board's current state, to the board.
+ * The solution is kept as long as every value set on the board agrees with it, and the board stays solvable while it is
+ * (see simpleSet).
+ */
+void setSolution(board* b, int* sol){
+	if (b->solution == NULL){
+		assert((b->solution = (int*) malloc(b->size*sizeof(int)))!=NULL && "Memory allocation error");
+	}
+	memcpy(b->solution, sol, b->size*sizeof(int));
+}
+
+/*
+ * Returns the value of cell index in the solution attached to the board, or 0 if no solution is attached.
+ */
+int solutionAt(board* b, int index){
+	return (b->solution == NULL) ? 0 : b->solution[index];
+}
+
+/*
+ * Returns the attached solution, or the last one dropped from the board, or NULL (see header).
+ */
+int* warmStart(board* b){
+	return (b->solution != NULL) ? b->solution : b->lastSolution;
+}
+
+/*
+ * Copies the hash of the board's current values (see stateCache.h) to hash.
+ */
+void getHash(board* b, unsigned long hash[2]){
+	hash[0] = b->hash[0];
+	hash[1] = b->hash[1];
+}
+
 /*
  * Returns the board's total size (number of cells).
  */
@@ -324,74 +375,43 @@ void applyMatrix(board *b, int* arr){
 }
 
 /*
- * A change was made block "blockNum".
- * Check all cells and update valid bit according to the new situation
- */
-void markBlock(board* b, int blockNum){
-	int index , k, max = getMaxVal(b), err=0;
-	cell* cur;
-	for (k = 0 ; k<(b->blockH); k++){
-		index = translateBlockIndex(blockNum, k, b->blockW, b->blockH);
-		cur = (b->puzzle) + index;
-		err = !isValidm(b->values, (index / max) , (index % max), b->values[index], b->blockW, b->blockH);
-		b->nerr += err - (cur->err); /*updates counter according to weather the cell was already erroneous*/
-		cur->err = err;
-	}
-}
-
-/*
- * A change was made to row i.
- * Check all cells and update valid bit according to the new situation
- */
-void markRow(board* b, int i){
-	int max = getMaxVal(b), j, err=0;
-	int index = i * max; /*first cell in row*/
-	cell* cur;
-	for (j = 0 ; j<max ; j++){
-		cur = (b->puzzle) + index;
-		err = !isValidm(b->values, i, j, b->values[index], b->blockW, b->blockH);
-		b->nerr += err - (cur->err); /*updates counter according to weather the cell was already erroneous*/
-		cur->err = err;
-		index++;
-	}
-}
-
-/*
- * A change was made to col j.
+ * A change was made to unit u (a row, column or block, numbered as in geometry.h).
  * Check all cells and update valid bit according to the new situation
  */
-void markCol(board* b, int j){
-	int max = getMaxVal(b), i, err=0;
-	int index = j;
+void markUnit(board* b, int u){
+	geometry* g = getGeometry(b->blockW, b->blockH);
+	int k, index, err=0, *cells = g->units + u*g->dim;
 	cell* cur;
-	for (i = 0 ; i<max ; i++){
+	for (k = 0 ; k<g->dim ; k++){
+		index = cells[k];
 		cur = (b->puzzle) + index;
-		err = !isValidm(b->values, i, j, b->values[index], b->blockW, b->blockH);
+		err = !isValidAt(b->values, g, index, b->values[index]);
 		b->nerr += err - (cur->err); /*updates counter according to weather the cell was already erroneous*/
 		cur->err = err;
-	index += max;
 	}
 }
 
 /*
- * update all errors created or fixed by last placement
+ * update all errors created or fixed by last placement to cell index
  * checks row, col and block even if error was already found, in order to update valid bits correctly
  */
-void markErr(board* b, int i, int j){
-	markRow(b,i);
-	markCol(b,j);
-	markBlock(b,getBlockNum(i,j,b->blockW,b->blockH));
+void markErr(board* b, int index){
+	geometry* g = getGeometry(b->blockW, b->blockH);
+	markUnit(b,g->rowOf[index]);
+	markUnit(b,g->dim + g->colOf[index]);
+	markUnit(b,2*g->dim + g->blockOf[index]);
 }
 
 /*
  * update all error bits in board.
  */
 void markAll(board* b){
-	int i, dim = b->blockW*b->blockH;
-	for (i=0 ; i<dim ; i++){
-		markRow(b,i);
-		markCol(b,i);
-		markBlock(b,i);
+	int i, *err;
+	assert((err = (int*) malloc(b->size*sizeof(int)))!=NULL && "Memory allocation error");
+	b->nerr = findErrors(b->values, b->blockW, b->blockH, err); /*whole board at once, see errCheck.h*/
+	for (i=0 ; i<b->size ; i++){
+		b->puzzle[i].err = err[i];
 	}
+	free(err);
 }
 
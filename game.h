@@ -44,6 +44,9 @@ typedef struct S_board{
 	int nerr; /*number of erroneous cells*/
 	int size; /*boards total size*/
 	int solvable; /*remembers if board was validated in it's current state, 0=no knowlage, 1= found solvable, -1=found infeasble*/
+	unsigned long hash[2]; /*hash of the cell values, kept up to date by every change (see stateCache.h)*/
+	int* solution; /*a solution that agrees with every value on the board (so it's a solution of the board), or NULL*/
+	int* lastSolution; /*the last solution dropped from the board, a warm start for solving it again, or NULL*/
 	history hist; /*move history*/
 } board;
 
@@ -134,6 +137,7 @@ int isEmpty(board* b);
 
 /*
  * Returns 1 if board was validated since last change and found solvable, -1 if found unsolvable, 0 if a change was made.
+ * Changes that keep the attached solution (see setSolution) keep the board solvable, so it's not validated again.
  */
 int isSolvable(board* b);
 
@@ -144,6 +148,29 @@ int isSolvable(board* b);
  */
 void setSolvable(board* b, int x);
 
+/*
+ * Attaches a copy of sol, a solution of the board's current state, to the board.
+ * The solution is kept as long as every value set on the board agrees with it (clearing cells keeps it too), and is
+ * dropped by the first placement that contradicts it. While it's kept, the board stays solvable.
+ */
+void setSolution(board* b, int* sol);
+
+/*
+ * Returns the value of cell index in the solution attached to the board, or 0 if no solution is attached.
+ */
+int solutionAt(board* b, int index);
+
+/*
+ * Returns the solution attached to the board, or if there is none, the last one dropped from it (which differs from the
+ * board only in a few placements), or NULL if the board never had one. Used to warm start the solver.
+ */
+int* warmStart(board* b);
+
+/*
+ * Copies the hash of the board's current values (see stateCache.h) to hash.
+ */
+void getHash(board* b, unsigned long hash[2]);
+
 /*
  * Returns the board's total size (number of cells).
  */
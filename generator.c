@@ -16,7 +16,7 @@
 #include <time.h>
 #include "sizes.h"
 #include "solver.h"
-#include "ILP.h"
+#include "backend.h"
 
 
 void findEmpty(int *b , int* empty ,int numEmpty, int size);
@@ -83,12 +83,12 @@ int generate(int* b, int x , int y, int blockw, int blockh, int numEmpty){
 		}
 		/*if we successfully assigned x cells try and solve board*/
 		if (!left){
-				if (solveB(b,blockw,blockh,1,-1)){
+				if (backendSolve(b,blockw,blockh,NULL) == 1){
 					finish = 1;
 					break; /*breaks out of the loop without restoring the board. this is the solution we return*/
 				}
 				else{
-					stillEmpty = 0; /*As solveB function might edit the board (full auto), we need to make sure the whole board is restored*/
+					stillEmpty = 0; /*As the solver might edit the board (full auto), we need to make sure the whole board is restored*/
 				}
 		}
 		restoreEmpty(b,empty,stillEmpty,numEmpty);
@@ -0,0 +1,111 @@
+/*
+ * geometry.c
+ *
+ *	Builds and caches the index tables of board layouts. See header.
+ *
+ *	Very few layouts are used in a single run (usually one), so the geometries are kept in a simple linked list, and the
+ *	last one returned is checked first.
+ *
+ *  Created on: Jul 16, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "solver.h"
+#include "geometry.h"
+
+geometry* buildGeometry(int blockW, int blockH);
+
+static geometry* geometries = NULL;
+static geometry* last = NULL;
+
+/*
+ * Returns the geometry of boards with blocks of blockW columns and blockH rows, building it on first use.
+ */
+geometry* getGeometry(int blockW, int blockH){
+	geometry* g;
+	if (last != NULL && last->blockW == blockW && last->blockH == blockH){
+		return last;
+	}
+	for (g = geometries ; g != NULL ; g = g->next){
+		if (g->blockW == blockW && g->blockH == blockH){
+			last = g;
+			return g;
+		}
+	}
+	g = buildGeometry(blockW, blockH);
+	g->next = geometries;
+	geometries = g;
+	last = g;
+	return g;
+}
+
+/*
+ * Frees all geometries built so far.
+ */
+void freeGeometries(void){
+	geometry* g;
+	while (geometries != NULL){
+		g = geometries;
+		geometries = g->next;
+		free(g->rowOf);
+		free(g->units);
+		free(g);
+	}
+	last = NULL;
+}
+
+/*
+ * Builds the tables of a single layout.
+ * A cell has dim-1 peers in it's row, dim-1 in it's column, and (blockW-1)*(blockH-1) more in it's block.
+ */
+geometry* buildGeometry(int blockW, int blockH){
+	geometry* g;
+	int dim = blockW*blockH, size = dim*dim, i, k, n, peer, u;
+	assert((g = (geometry*) malloc(sizeof(geometry)))!=NULL && "Memory allocation error");
+	g->blockW = blockW;
+	g->blockH = blockH;
+	g->dim = dim;
+	g->size = size;
+	g->numPeers = 2*(dim - 1) + (blockW - 1)*(blockH - 1);
+	assert((g->rowOf = (int*) malloc(3*size*sizeof(int)))!=NULL && "Memory allocation error");
+	g->colOf = g->rowOf + size;
+	g->blockOf = g->colOf + size;
+	assert((g->units = (int*) malloc((3*size + size*g->numPeers)*sizeof(int)))!=NULL && "Memory allocation error");
+	g->peers = g->units + 3*size;
+	for (i = 0 ; i < size ; i++){
+		g->rowOf[i] = i / dim;
+		g->colOf[i] = i % dim;
+		g->blockOf[i] = getBlockNum(i / dim, i % dim, blockW, blockH);
+	}
+	for (u = 0 ; u < dim ; u++){
+		for (k = 0 ; k < dim ; k++){
+			g->units[u*dim + k] = u*dim + k;
+			g->units[(dim + u)*dim + k] = k*dim + u;
+			g->units[(2*dim + u)*dim + k] = translateBlockIndex(u, k, blockW, blockH);
+		}
+	}
+	for (i = 0 ; i < size ; i++){
+		n = 0;
+		for (k = 0 ; k < dim ; k++){
+			peer = g->units[g->rowOf[i]*dim + k];
+			if (peer != i){
+				g->peers[i*g->numPeers + n] = peer;
+				n++;
+			}
+			peer = g->units[(dim + g->colOf[i])*dim + k];
+			if (peer != i){
+				g->peers[i*g->numPeers + n] = peer;
+				n++;
+			}
+			peer = g->units[(2*dim + g->blockOf[i])*dim + k];
+			if (g->rowOf[peer] != g->rowOf[i] && g->colOf[peer] != g->colOf[i]){ /*the rest were listed with the row or column*/
+				g->peers[i*g->numPeers + n] = peer;
+				n++;
+			}
+		}
+	}
+	return g;
+}
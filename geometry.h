@@ -0,0 +1,44 @@
+/*
+ * geometry.h
+ *
+ *	Index tables for a board layout (block sizes), so code that walks rows, columns, blocks and peers doesn't have to
+ *	recompute indices with divisions and modulo (which is irregular for rectangular blocks) every time.
+ *
+ *	A geometry holds, for every cell, it's row, column and block, and it's flat list of peers (the cells sharing a row,
+ *	column or block with it, each one listed once). It also holds the cells of every unit: units 0..dim-1 are the rows,
+ *	dim..2*dim-1 the columns and 2*dim..3*dim-1 the blocks (blocks are numbered like getBlockNum does, cells in a unit are
+ *	in row major order).
+ *
+ *	Geometries are built once per block sizes and kept until freeGeometries is called (at exit), so callers never free
+ *	them. Building a geometry is not thread safe: code that runs on several threads must get it's geometry first.
+ *
+ *  Created on: Jul 16, 2019
+ *      Author: Edanz
+ */
+
+#ifndef GEOMETRY_H_
+#define GEOMETRY_H_
+
+typedef struct S_geometry{
+	int blockW;
+	int blockH;
+	int dim; /*number of values, cells in a unit*/
+	int size; /*number of cells*/
+	int *rowOf, *colOf, *blockOf; /*row, column and block of every cell*/
+	int *units; /*units[u*dim + k] is the k'th cell of unit u*/
+	int numPeers; /*number of peers of every cell*/
+	int *peers; /*peers[cell*numPeers + p] is the p'th peer of cell*/
+	struct S_geometry* next; /*next geometry built*/
+} geometry;
+
+/*
+ * Returns the geometry of boards with blocks of blockW columns and blockH rows, building it on first use.
+ */
+geometry* getGeometry(int blockW, int blockH);
+
+/*
+ * Frees all geometries built so far.
+ */
+void freeGeometries(void);
+
+#endif /* GEOMETRY_H_ */
@@ -18,12 +18,20 @@
 #include "parser.h"
 #include "game.h"
 #include "dispatcher.h"
+#include "settings.h"
+#include "geometry.h"
+#include "stateCache.h"
+#include "ILP.h"
 
-int main (void){
+int main (int argc, char* argv[]){
 	mode m = init;
 	board* b = NULL;
 	int cmd[5], mark = 1, finish = 0;
 	char name[1024] = {0}, str[COMMAND_LEN+2] = {0};
+	if (!readArgs(argc,argv)){
+		puts("usage: sudoku-console [-t threads] [-s solver] [-c counter]");
+		return 1;
+	}
 	puts("Hello! this is a new game of Sudoku, please enter your commands to play");
 	while (!finish && fgets(str,COMMAND_LEN+2,stdin)!=NULL){
 		if (strlen(str) > COMMAND_LEN){
@@ -40,5 +48,8 @@ int main (void){
 		destoryBoard(b);
 		b = NULL;
 	}
+	freeGeometries();
+	freeCache();
+	freeILP();
 	return 0;
 }
@@ -14,14 +14,26 @@
 #include "files.h"
 #include "solver.h"
 #include "game.h"
-#include "ILP.h"
 #include "generator.h"
+#include "bitSolver.h"
+#include "settings.h"
+#include "parallel.h"
+#include "bigNum.h"
+#include "propagate.h"
+#include "backend.h"
+#include "symmetry.h"
+#include "stateCache.h"
+#include "diskCache.h"
 
 void printBoard(int arr[], int blockw, int blockh, int mark);
 void handlePrint(board *b,int mark);
 int validCord(board *b, int *cmd);
 void handleGameOver(board *b, mode *m);
 int validate(board *b);
+void countSolutions(int* arr, int blockw, int blockh, int limit, bigNum* count);
+void countPlain(int* arr, int blockw, int blockh, int limit, bigNum* count);
+void countSerial(int* arr, int blockw, int blockh, int limit, bigNum* count);
+stateEntry* knownState(board *b, int add);
 
 /*
  *
@@ -57,6 +69,10 @@ void handleParse(int* res, mode m){
 		}
 		case -3:{
 			printf("Illegal number of arguments\n");
+			if (res[0]==12){
+				puts("this command takes no more than one argument (optional limit on the number of solutions)");
+				return;
+			}
 			if (res[0]==4 || res[0]==6 || res[0]==8 || res[0]==9 || res[0]>=12){
 				puts("this command takes no arguments");
 				return;
@@ -205,6 +221,10 @@ void handleVali(board *b){
 		printf("Board is currently not valid \n");
 		return;
 	}
+	if (tmp==-2){
+		printf("Error: could not validate the board, the solver failed\n");
+		return;
+	}
 	printf("board is ");
 	if (tmp == 0){
 		printf("un");
@@ -213,11 +233,16 @@ void handleVali(board *b){
 }
 
 /*
- * Returns 1 if board is solvable, 0 otherwise.
+ * Returns 1 if board is solvable, 0 otherwise (-1 if the board isn't valid, -2 if the solver failed so it's unknown).
  * Separated from handleVali as this function is a perliminary step in many commands.
+ * A state that was already solved (even before some changes that were undone since) isn't solved again, see stateCache.h,
+ * and neither is a board found in the disk cache (if used, see diskCache.h) or one that still agrees with it's last
+ * solution (see setSolution in game.h). Otherwise the solver starts from the last solution, which a board that stopped
+ * agreeing with it usually differs from in only a few cells.
  */
 int validate(board *b){
-	int *arr, tmp,blockdim[2];
+	int *arr, tmp,blockdim[2],size = getSize(b);
+	stateEntry* e;
 	if (!(allValid(b))){
 		return -1;
 	}
@@ -227,15 +252,53 @@ int validate(board *b){
 	if (isSolvable(b)!=0){ /*this board was already checked*/
 		return(isSolvable(b)==1);
 	}
-	assert((arr = (int*) calloc (getSize(b),sizeof(int)))!=NULL && "Memory allocation error");
+	e = knownState(b,0);
+	if (e != NULL && e->solvable != 0){ /*this state was checked before*/
+		setSolvable(b,e->solvable);
+		if (e->solution != NULL){
+			setSolution(b,e->solution);
+		}
+		return(e->solvable==1);
+	}
+	assert((arr = (int*) calloc (2*size,sizeof(int)))!=NULL && "Memory allocation error"); /*board, then it's solution*/
 	toArray(b,arr,1);
 	getBlockDim(b,blockdim);
-	tmp = solveB(arr, blockdim[0], blockdim[1], 0,-1); /*1 if successful, 0 otherwise*/
-	free(arr);
+	tmp = diskFind(arr, blockdim[0], blockdim[1], arr+size);
+	if (!tmp){
+		memcpy(arr+size,arr,size*sizeof(int));
+		tmp = backendSolve(arr+size, blockdim[0], blockdim[1], warmStart(b)); /*1 if successful, 0 if there is no solution*/
+		if (tmp < 0){ /*the engine failed, nothing is known about the board, so nothing is recorded*/
+			free(arr);
+			return -2;
+		}
+		if (tmp){
+			diskStore(arr, blockdim[0], blockdim[1], arr+size);
+		}
+	}
+	/*a definitive answer from here on (solved, or proven to have no solution), so it's recorded*/
 	setSolvable(b,(tmp? 1:-1));
+	if (tmp){
+		setSolution(b,arr+size);
+	}
+	if ((e = knownState(b,1)) != NULL){
+		cacheSolved(e,(tmp? 1:-1),arr+size,size);
+	}
+	free(arr);
 	return tmp;
 }
 
+/*
+ * Returns what the state cache knows about the current state of board b, or NULL if it has nothing.
+ * If add is 1, the state is added to the cache (with nothing known about it) if it isn't there.
+ */
+stateEntry* knownState(board *b, int add){
+	unsigned long hash[2];
+	int blockdim[2];
+	getHash(b,hash);
+	getBlockDim(b,blockdim);
+	return add ? cacheAdd(hash,blockdim[0],blockdim[1]) : cacheFind(hash,blockdim[0],blockdim[1]);
+}
+
 /*
  * Generates a board according to user input:
  *
@@ -244,7 +307,7 @@ int validate(board *b){
  *
  */
 void handleGen(board *b, int cmd[]){
-	int empty = numFree(b), *arr, size, blockdim[2];
+	int empty = numFree(b), *arr, size, tmp, blockdim[2];
 	if (cmd[1] < 0){
 		puts("parameter 1 can't be negative");
 	}
@@ -260,7 +323,12 @@ void handleGen(board *b, int cmd[]){
 		printf("Board contains less than %d cells\n",cmd[2]);
 		return;
 	}
-	if (validate(b)!=1){
+	tmp = validate(b);
+	if (tmp == -2){
+		puts("Error: could not validate the board, the solver failed");
+		return;
+	}
+	if (tmp != 1){
 		puts("board is currently not solvable");
 		return;
 	}
@@ -313,6 +381,7 @@ void handleDo(board *b, int mark, int un, mode m){
  */
 void handleSave(board *b,mode m, char *name){
 	int tmp, *arr, blockdim[2];
+	stateEntry* e;
 	if (m==edit){
 		tmp = validate(b);
 		if (tmp == -1){
@@ -323,6 +392,10 @@ void handleSave(board *b,mode m, char *name){
 			puts("Board is unsolvable and not allowed to be saved");
 			return;
 		}
+		if (tmp == -2){
+			puts("Error: could not validate the board, the solver failed, so it's not saved");
+			return;
+		}
 	}
 	assert((arr = (int*) calloc (getSize(b),sizeof(int)))!=NULL && "Memory allocation error");
 	toArray(b,arr,0);
@@ -330,6 +403,11 @@ void handleSave(board *b,mode m, char *name){
 	if (!save(name,arr, blockdim[0], blockdim[1], m)){
 		puts("file error");
 	}
+	e = knownState(b,0);
+	if (e != NULL && e->solution != NULL){ /*so the saved puzzle isn't solved again when it's loaded later*/
+		toArray(b,arr,1);
+		diskStore(arr, blockdim[0], blockdim[1], e->solution);
+	}
 	free(arr);
 	printf("Saved puzzle to file:%s\n",name);
 }
@@ -353,6 +431,10 @@ int validCord(board *b, int *cmd){
 /*
  * prints a placement to cell cmd[2],cmd[1] that will keep the board solvable,
  * or prints an error if no such placement exists
+ *
+ * The value is read from the solution attached to the board (see setSolution in game.h). If there is none, the whole board
+ * is solved once by validate, which attaches it's solution, so the following hints cost nothing until a placement
+ * contradicts it.
  */
 void handleHint(board *b, int *cmd){
 	int *arr, tmp, blockdim[2];
@@ -371,15 +453,21 @@ void handleHint(board *b, int *cmd){
 		puts("Cell already contains a value!");
 		return;
 	}
-	if (isSolvable(b)==-1){
-		puts("Board is not solvable");
+	tmp = solutionAt(b,cordToInd(b,cmd+1));
+	if (!tmp && (tmp = validate(b))==1){
+		tmp = solutionAt(b,cordToInd(b,cmd+1));
+		if (!tmp){ /*known to be solvable without solving it (such as an empty board)*/
+			assert((arr = (int*) calloc (getSize(b),sizeof(int)))!=NULL && "Memory allocation error");
+			toArray(b,arr,1);
+			getBlockDim(b,blockdim);
+			tmp = backendHint(arr, cordToInd(b,cmd+1), blockdim[0], blockdim[1]);
+			free(arr);
+		}
+	}
+	if (tmp < 0){ /*validate (the board is valid here) or the engine failed*/
+		puts("Error: could not find a hint, the solver failed");
 		return;
 	}
-	assert((arr = (int*) calloc (getSize(b),sizeof(int)))!=NULL && "Memory allocation error");
-	toArray(b,arr,1);
-	getBlockDim(b,blockdim);
-	tmp = hint(arr, cordToInd(b,cmd+1), blockdim[0], blockdim[1]);
-	free(arr);
 	if (!(tmp)){
 		puts("Board is not solvable");
 		return;
@@ -389,34 +477,113 @@ void handleHint(board *b, int *cmd){
 
 /*
  * Prints number of possible solutions to the board, or error if none exist
+ * If limit is positive, counting stops once limit solutions were found (and "at least limit" solutions are reported).
  */
-void handleNum(board *b){
-	int *arr,tmp,blockdim[2];
-	char *c, *s;
+void handleNum(board *b, int limit){
+	int *arr,blockdim[2],bounded,single;
+	char *c, *s, num[BIG_STR_LEN];
+	bigNum count;
+	stateEntry* e;
+	if (limit == 0){
+		puts("the limit on the number of solutions should be a positive integer");
+		return;
+	}
 	if (!(allValid(b))){
 		printf("board is not valid, there are 0 possible solutions\n");
 		return;
 	}
-	if (isSolvable(b)==-1){
+	e = knownState(b,0);
+	if (isSolvable(b)==-1 || (e != NULL && e->solvable==-1)){
 		puts("there are 0 possible solutions to this board");
 		return;
 	}
 	assert((arr = (int*) calloc (getSize(b),sizeof(int)))!=NULL && "Memory allocation error");
 	toArray(b,arr,1);
 	getBlockDim(b,blockdim);
-	tmp = num_solutions(arr, blockdim[0], blockdim[1]);
-	s = (tmp>1 || tmp==0) ? "are" : "is";
-	c = (tmp>1 || tmp==0) ? "s " : " ";
-	printf("there %s %d possible solution%sto this board\n",s,tmp,c);
-	setSolvable(b,(tmp>0 ? 1 : -1));
+	bigSet(&count, 0);
+	if (e == NULL || !cachedCount(e, limit, &count)){ /*not counted before*/
+		countSolutions(arr, blockdim[0], blockdim[1], limit, &count);
+		if ((e = knownState(b,1)) != NULL){
+			cacheCount(e, &count, limit);
+		}
+	}
+	bounded = (limit > 0 && bigAtLeast(&count, limit));
+	if (bounded){
+		bigSet(&count, limit); /*parallel counting might pass the limit a bit*/
+	}
+	bigToString(&count, num);
+	single = (bigToInt(&count) == 1);
+	s = single ? "is" : "are";
+	c = single ? " " : "s ";
+	if (count.overflow){
+		printf("there are more than %s possible solutions to this board\n",num);
+	}
+	else{
+		printf("there %s %s%s possible solution%sto this board\n",s,(bounded ? "at least " : ""),num,c);
+	}
+	setSolvable(b,(bigAtLeast(&count, 1) ? 1 : -1));
 	free(arr);
 }
 
+/*
+ * Adds the number of solutions of board arr to count, with the engine and number of threads chosen in settings.
+ * Stops once count reaches limit (if limit is positive).
+ * A uniqueness check is a count with limit 2.
+ *
+ * Unless turned off in settings, a count with no limit is reduced by the symmetries of the board (symmetry module), and
+ * each of the sub boards it is split to is counted by countPlain. A bounded count (which is usually stopped early
+ * anyway) is counted by countPlain directly.
+ */
+void countSolutions(int* arr, int blockw, int blockh, int limit, bigNum* count){
+	if (limit <= 0 && getSettings()->symmetry){
+		symCount(arr, blockw, blockh, count, countPlain);
+	}
+	else{
+		countPlain(arr, blockw, blockh, limit, count);
+	}
+}
+
+/*
+ * Adds the number of solutions of board arr to count, with the engine and number of threads chosen in settings.
+ * Stops once count reaches limit (if limit is positive).
+ *
+ * Unless turned off in settings, the deductions of the propagate module are made on arr first (so arr might be changed),
+ * which doesn't change the number of solutions, but leaves less for the engine to search, and ends the count right away
+ * if a contradiction is found. The bitmask engine also gets the candidates ruled out by the deductions.
+ */
+void countPlain(int* arr, int blockw, int blockh, int limit, bigNum* count){
+	bitmask* cands = NULL;
+	propStats stats;
+	int ok = 1;
+	if (getSettings()->propagate && blockw*blockh <= MAX_BIT_DIM){
+		assert((cands = (bitmask*) malloc(blockw*blockh*blockw*blockh*sizeof(bitmask)))!=NULL && "Memory allocation error");
+		clearPropStats(&stats);
+		ok = propagate(arr, cands, blockw, blockh, &stats);
+		if (getSettings()->stats){
+			printPropStats(&stats);
+		}
+	}
+	if (ok && getSettings()->threads > 1){
+		parallelCount(arr, blockw, blockh, getSettings()->threads, limit, count, countSerial);
+	}
+	else if (ok){
+		backendCount(arr, blockw, blockh, cands, limit, count);
+	}
+	free(cands);
+}
+
+/*
+ * Adds the number of solutions of board arr to count on a single thread, with the engine chosen in settings.
+ */
+void countSerial(int* arr, int blockw, int blockh, int limit, bigNum* count){
+	backendCount(arr, blockw, blockh, NULL, limit, count);
+}
+
 /*
  * Filles every empty cell with only 1 possible value, or prints error if not possible.
  */
 void handleAuto(board *b, int mark,mode *m){
-	int tmp, *arr1, *arr2, *options, size, blockdim[2];
+	int tmp, *arr1, *arr2, size, blockdim[2];
 	if (!(allValid(b))){
 		printf("board is not valid please correct and try again");
 		return;
@@ -425,17 +592,14 @@ void handleAuto(board *b, int mark,mode *m){
 	assert((arr1 = (int*) calloc(size,sizeof(int)))!=NULL && "Memory allocation error");
 	toArray(b,arr1,1);
 	assert((arr2 = (int*) calloc(size,sizeof(int)))!=NULL && "Memory allocation error");
-	assert((options = (int*) malloc(getMaxVal(b)*sizeof(int)))!=NULL && "Memory allocation error");
 	getBlockDim(b,blockdim);
-	if ((tmp = autofill(arr1,arr2,options,blockdim[0],blockdim[1]))==0){
+	if ((tmp = autofill(arr1,arr2,blockdim[0],blockdim[1]))==0){
 		free(arr1);
 		free(arr2);
-		free(options);
 		printf("There are no obvious assignments, no changes were made to the board\n");
 		return;
 	}
 	free(arr2);
-	free(options);
 	printf("%d cells were filled:\n",tmp);
 	applyMatrix(b, arr1);
 	free(arr1);
@@ -84,8 +84,10 @@ void handleHint(board *b, int *cmd);
 
 /*
  * Prints number of possible solutions to the board, or error if none exist
+ * If limit is positive, counting stops once limit solutions were found. limit 0 is an illegal limit given by the user,
+ * and a negative limit means there is none.
  */
-void handleNum(board *b);
+void handleNum(board *b, int limit);
 
 /*
  * Filles every empty cell with only 1 possible value, or prints error if not possible.
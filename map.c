@@ -15,6 +15,10 @@
  *	My solution to this problem is to keep a custom data structure mapping between the cells and the variables that represent them.
  *	The data structure itself is implemented in the header file.
  *	This module will hold implementation of functions that operate on this structure and keep it abstract from the rest of the project.
+ *
+ *	All lookups are a single array access: the variables of a cell are numbered consecutively (in increasing order of
+ *	their values), so a cell only needs the number of it's first variable, and the (cell, value) and variable -> cell
+ *	tables are filled while the variables are numbered.
  */
 
 
@@ -23,9 +27,7 @@
 #include <assert.h>
 #include "solver.h"
 #include "map.h"
-
-void pack(cell* c, mnode** cur,int j);
-void destroyCell(mnode* n);
+#include "geometry.h"
 
 /*
  * Initializes a mapping for board b, and Returns a pointer to the new data structure created.
@@ -34,45 +36,60 @@ void destroyCell(mnode* n);
  * Creates the data structure containing the data needed for each cell- what numbers are possible assignments
  * and index of first variable belonging each cell.
  *
+ * If cands is not NULL, it holds the candidates of every cell (as found by propagate), and only values that are candidates
+ * get a variable.
+ *
  * If it's obvious during the mapping that no solution is possible, we will return NULL
  *
- * Note that it wouldv'e saved us some CPU time if we built our constraints to the optimizer together with the map
- * (each time we create a variable we already now exactly what constraints it will appear in).
- * This though will cause significant memory usage (we can't despatch the constraints until we went over the entire board-
- * so we will have to keep O(3 * n^2) memory just for the constraints.
- * Current approach will add O(3*n) to the running time, but will save the O(n^2) memory.
+ * Note that we could build our constraints to the optimizer together with the map (each time we create a variable we
+ * already now exactly what constraints it will appear in).
+ * The ILP module builds them in a single block right after the map anyway (so they are added to the model with a single
+ * call, see addConstrs), which is a pass over the units with O(1) lookups. Building them here would save only that pass,
+ * and would tie the map to the optimizer, so it is not done.
  *
  */
-map* createMap(int* b, int blockw, int blockh){
-	int i, j, maxVal = (blockw*blockh), size = maxVal * maxVal;
+map* createMap(int* b, bitmask* cands, int blockw, int blockh){
+	int i, j, maxVal = (blockw*blockh), size = maxVal * maxVal, words = CAND_WORDS(maxVal);
+	geometry* g = getGeometry(blockw, blockh);
+	bitmask* s;
 	map* m;
-	mnode* cur;
-	cell* c;
-	/*allocate space for the map, and for the cells themselves*/
+	/*allocate space for the map, and for the tables (a cell has at most maxVal variables)*/
 	assert((m = (map*) (calloc(1,sizeof(map))))!=NULL && "Memory allocation error");
 	m->size = size;
+	m->dim = maxVal;
 	m->total = 0;
-	assert(((m->cells) =  calloc(size,sizeof(mnode)))!=NULL && "Memory allocation error");
+	assert((m->first = (int*) malloc((size + 1 + size*maxVal)*sizeof(int)))!=NULL && "Memory allocation error");
+	m->varOf = m->first + size + 1;
+	assert((m->vals = (int*) malloc(2*size*maxVal*sizeof(int)))!=NULL && "Memory allocation error");
+	m->cellOf = m->vals + size*maxVal;
+	assert((s = (bitmask*) malloc(words*sizeof(bitmask)))!=NULL && "Memory allocation error");
 	/*start filling map*/
 	for (i = 0 ; i < size ; i++){
-		((m->cells)[i]).index = m->total;
-		((m->cells)[i]).num = 0;
-		c = &(m->cells)[i];
+		m->first[i] = m->total;
+		for (j = 0 ; j < maxVal ; j++){
+			m->varOf[i*maxVal + j] = -1;
+		}
 		if (b[i]!=0){
 			continue; /*we already have a placement for this cell no need to create any mappings*/
 		}
-		for (j=1 ; j <= maxVal ; j++){
-			if (isValidm(b,(i/maxVal),(i%maxVal),j,blockw,blockh)){ /*from solver module- checks if j is a valid placement for this cell*/
-				(m->cells)[i].num++; /*another variable for this cell*/
-				pack(c,&cur,j); /*encodes in map data structure that value j is a valid candidate for this cell, updates cur to next node*/
-			}
+		findCands(b,g,i,s); /*from solver module- the valid placements for this cell*/
+		if (cands != NULL){ /*drop values ruled out by propagation (only done on boards that fit a single word)*/
+			s[0] &= cands[i];
+		}
+		for (j = candNext(s,words,0) ; j != 0 ; j = candNext(s,words,j)){ /*another variable for this cell*/
+			m->varOf[i*maxVal + j - 1] = m->total;
+			m->vals[m->total] = j;
+			m->cellOf[m->total] = i;
+			m->total++;
 		}
-		if ((m->cells)[i].num==0){ /*this cell in board did not give any variables even though it's still empty*/
+		if (m->first[i] == m->total){ /*this cell in board did not give any variables even though it's still empty*/
+			free(s);
 			destroyMap(m);
 			return NULL;
 		}
-		m->total+=(((m->cells)[i]).num);
 	}
+	m->first[size] = m->total;
+	free(s);
 	return m;
 }
 
@@ -92,7 +109,7 @@ int GetNumVar(map* m){
  * Returns how many variables this cell contributed to the model.
  */
 int GetNumCell (map* m, int index){
-	return ((m->cells[index]).num);
+	return (m->first[index + 1] - m->first[index]);
 }
 
 /*
@@ -101,10 +118,10 @@ int GetNumCell (map* m, int index){
  *
  */
 int GetLastVar(map* m, int index){
-	if ((m->cells[index]).num == 0){
+	if (m->first[index + 1] == m->first[index]){
 		return -1; /*no variables for this cell*/
 	}
-	return ((m->cells[index]).index + (m->cells[index]).num -1);
+	return (m->first[index + 1] - 1);
 }
 
 /*
@@ -112,10 +129,10 @@ int GetLastVar(map* m, int index){
  * Receives a pointer to the mapping and an index of a cell on the board.
  */
 int GetFirstVar(map* m, int index){
-	if ((m->cells[index]).num == 0){
-			return -1; /*no variables for this cell*/
+	if (m->first[index + 1] == m->first[index]){
+		return -1; /*no variables for this cell*/
 	}
-	return (((m->cells)[index]).index);
+	return (m->first[index]);
 }
 
 /*
@@ -124,50 +141,21 @@ int GetFirstVar(map* m, int index){
  *If there is no such variable, Returns -1
  */
 int getMapping(map* m, int ind, int value){
-	mnode* cur;
-	int mapping;
-	if (m == NULL || ((m->cells[ind]).num)==0){
+	if (m == NULL || value < 1 || value > m->dim){
 		return -1;
 	}
-	cur = (m->cells[ind]).list;
-	mapping = (m->cells[ind]).index;
-	while (cur != NULL){
-		if (cur->val == value){
-			return mapping;
-		}
-		cur = cur->next;
-		mapping++;
-	}
-	return -1;
+	return (m->varOf[ind*m->dim + value - 1]);
 }
 
 /*
  *	Returns the index of the cell variable var belongs to.
  *	Receives a pointer to the map and the number of variable we wish to associate with a cell.
- *	Uses a variation on Binary search to economize.
  */
 int getCell(map* m, int var){
-	int up, down, mid;
 	if (m==NULL || (var >= (m->total)) || (var <0)){
 		return -1;
 	}
-	up = m->size-1;
-	down = 0;
-	while (up>=down){
-		mid = ((up+down)/2);
-		if (((m->cells)[mid]).index > var){ /*smallest variable in this cell is larger than var*/
-			up = mid-1;
-		}
-		else{
-			if (((((m->cells)[mid]).index + ((m->cells)[mid]).num) -1)  < var){ /*largest variable in this cell is smaller than var*/
-				down = mid+1;
-			}
-			else{
-				return mid;
-			}
-		}
-	}
-	return -1;
+	return (m->cellOf[var]);
 }
 
 /*
@@ -175,56 +163,17 @@ int getCell(map* m, int var){
  * If var doesn't belong to cell[index] returns -1
  */
 int getVal(map* m, int ind, int var){
-	mnode* cur;
-	int get;
-	if (m==NULL || ind<0 || ind >= m->size || var < 0 || var >= m->total || (m->cells[ind].num == 0)){
+	if (m==NULL || ind<0 || ind >= m->size || var < 0 || var >= m->total || m->cellOf[var] != ind){
 		return -1;
 	}
-	get = ((m->cells[ind]).index);
-	cur = (m->cells[ind]).list;
-	while ((get!=var) && (cur)!=NULL){
-		cur=cur->next;
-		get++;
-	}
-	return ((cur==NULL)? -1 : cur->val); /*if null return -1 otherwise we found the value*/
+	return (m->vals[var]);
 }
 
 /*
- * Auxiliary function to insert another variable into the mapping.
- * This function receives a pointer to the map, pointer to the last updated node in the list of this cell (or to this cell if no
- * variable was updated yet) and the placement value this cell represents.
- *
- * The function extends the list in this cell of the map, adding a node representing the new variable.
- */
-void pack(cell* c, mnode** cur,int j){
-	if ((c->list)==NULL){
-		assert((c->list = (mnode*) (calloc(1,sizeof(mnode))))!=NULL && "Memory allocation error");
-		*cur = c->list;
-		(*cur)->val = j;
-		return;
-	}
-	assert((((*cur)->next) = (mnode*) (calloc(1,sizeof(mnode))))!=NULL && "Memory allocation error");
-	*cur = (*cur)->next;
-	(*cur)->val = j;
-}
-
-/*
- * frees all allocate data to this map and it's cells.
+ * frees all allocate data to this map and it's tables.
  */
 void destroyMap(map* m){
-	int i;
-	for (i=0 ; i < m->size ; i++){
-		destroyCell((&(m->cells[i]))->list);
-	}
-	free(m->cells);
+	free(m->first);
+	free(m->vals);
 	free(m);
 }
-
-void destroyCell(mnode* n){
-	mnode* tmp;
-	while (n!=NULL){
-		tmp = n->next;
-		free(n);
-		n = tmp;
-	}
-}
@@ -4,15 +4,15 @@
  *	This header holds the implementation for the data structure that is used to map between a cell to the variables that were
  *	sent to the optimizer.
  *
- *	The data structure itself wraps an array with the same dimensions as the board.
- *	Each cell of the array is a custom structure:
- *		int field, contains the index of the first variable belonging to this cell in the optimizer.
- *			- this helps us map what variable belongs to what cell more easly.
- *		pointer to a list:
- *			- each node representing a variable in the optimizer
- *	besides the array, the map holds additional helpful meta-data:
+ *	The variables of every cell are numbered consecutively, so the data structure is a few flat arrays:
+ *		first: index of the first variable belonging to every cell in the optimizer (first[size] is the total), so cell i
+ *			owns variables first[i]..first[i+1]-1.
+ *		vals and cellOf: the value and the cell of every variable.
+ *		varOf: the variable of every (cell, value) pair, or -1 if that value got no variable.
+ *	besides the arrays, the map holds additional helpful meta-data:
  *		- total: number of variables in play.
  *		- size: size of the board that is mapped.
+ *		- dim: number of values.
  *
  *  Created on: Apr 18, 2019
  *      Author: Edanz
@@ -21,21 +21,16 @@
 #ifndef MAP_H_
 #define MAP_H_
 
-typedef struct n{
-	int val; /*the value this variable represents*/
-	struct n* next;
-}mnode;
+#include "bitSolver.h"
 
-typedef struct c{
-	int num; /*number of variables in list*/
-	int index; /*index of first variable belonging to this cell*/
-	mnode* list;
-}cell;
-
-typedef struct m{
-	cell* cells; /*array holding lists for each cell*/
+typedef struct S_map{
+	int* first; /*first[i] is the first variable of cell i, first[size] is total*/
+	int* vals; /*vals[var] is the value variable var represents*/
+	int* cellOf; /*cellOf[var] is the cell variable var belongs to*/
+	int* varOf; /*varOf[i*dim + v-1] is the variable placing v in cell i, or -1*/
 	int total; /*total number of variables in this model*/
 	int size; /*size of the map (identical to the size of the board*/
+	int dim; /*number of values*/
 }map;
 
 /*
@@ -45,13 +40,16 @@ typedef struct m{
  * Creates the data structure containing the data needed for each cell- what numbers are possible assignments
  * and index of first variable belonging each cell.
  *
+ * If cands is not NULL, it holds the candidates of every cell (as found by propagate), and only values that are candidates
+ * get a variable.
+ *
  * If it's obvious during the mapping that no solution is possible, we will return NULL
  *
  */
-map* createMap(int* b, int blockw, int blockh);
+map* createMap(int* b, bitmask* cands, int blockw, int blockh);
 
 /*
- * frees all allocate data to this map and it's cells.
+ * frees all allocate data to this map and it's tables.
  */
 void destroyMap(map* m);
 
@@ -90,7 +88,6 @@ int getMapping(map* m, int index, int val);
 /*
  *	Returns the cell index of the cell variable var belongs to.
  *	Receives a pointer to the map and the number of relevant variable.
- *	Uses a variation on Binary search to economize.
  */
 int getCell(map* m, int var);
 
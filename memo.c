@@ -0,0 +1,112 @@
+/*
+ * memo.c
+ *
+ *	Transposition table with clock replacement. See header.
+ *
+ *  Created on: Jul 27, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "memo.h"
+
+memoEntry* findSlot(memoTable* t, unsigned long key, unsigned long check);
+
+/*
+ * Allocates a table with as many slots as fit in megabytes MB (at least MEMO_WAYS).
+ */
+void initMemo(memoTable* t, int megabytes){
+	t->size = ((unsigned long) megabytes << 20) / sizeof(memoEntry);
+	if (t->size < MEMO_WAYS){
+		t->size = MEMO_WAYS;
+	}
+	assert((t->slots = (memoEntry*) calloc(t->size, sizeof(memoEntry)))!=NULL && "Memory allocation error");
+	t->lookups = 0;
+	t->hits = 0;
+	t->stores = 0;
+	t->evictions = 0;
+}
+
+/*
+ * Frees the slots of table t.
+ */
+void freeMemo(memoTable* t){
+	free(t->slots);
+	t->slots = NULL;
+}
+
+/*
+ * Returns the slot holding state (key, check) in table t, or NULL if it isn't there.
+ */
+memoEntry* findSlot(memoTable* t, unsigned long key, unsigned long check){
+	unsigned long i, home = key % t->size;
+	memoEntry* e;
+	for (i = 0 ; i < MEMO_WAYS ; i++){
+		e = t->slots + (home + i) % t->size;
+		if (!e->used){
+			return NULL; /*slots are never emptied, so the state isn't further either*/
+		}
+		if (e->key == key && e->check == check){
+			return e;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * If the state (key, check) is in table t, sets count to it's count and returns 1, otherwise returns 0.
+ */
+int memoGet(memoTable* t, unsigned long key, unsigned long check, unsigned long* count){
+	memoEntry* e = findSlot(t, key, check);
+	t->lookups++;
+	if (e == NULL){
+		return 0;
+	}
+	t->hits++;
+	e->ref = 1;
+	*count = e->count;
+	return 1;
+}
+
+/*
+ * Stores count (at most MEMO_MAX_COUNT) as the count of state (key, check) in table t.
+ * Takes the first free slot of the key, or the first one not referenced since the clock last passed it (the home slot
+ * if all of them were).
+ */
+void memoPut(memoTable* t, unsigned long key, unsigned long check, unsigned long count){
+	unsigned long i, home = key % t->size;
+	memoEntry *e, *victim = NULL;
+	for (i = 0 ; i < MEMO_WAYS && victim == NULL ; i++){
+		e = t->slots + (home + i) % t->size;
+		if (!e->used || (e->key == key && e->check == check)){
+			victim = e;
+		}
+		else if (!e->ref){
+			victim = e;
+			t->evictions++;
+		}
+		else{
+			e->ref = 0; /*second chance*/
+		}
+	}
+	if (victim == NULL){
+		victim = t->slots + home;
+		t->evictions++;
+	}
+	victim->key = key;
+	victim->check = check;
+	victim->count = count;
+	victim->used = 1;
+	victim->ref = 0;
+	t->stores++;
+}
+
+/*
+ * Prints the hit rate and usage of table t.
+ */
+void printMemoStats(memoTable* t){
+	printf("memo: %lu lookups, %lu hits (%.1f%%), %lu stored, %lu evicted, %lu slots\n", t->lookups, t->hits,
+			(t->lookups > 0) ? 100.0*t->hits/t->lookups : 0.0, t->stores, t->evictions, t->size);
+}
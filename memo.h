@@ -0,0 +1,65 @@
+/*
+ * memo.h
+ *
+ *	Transposition table of the bitmask counter: maps the state left to search (see bitSolver.c for how it's keyed) to the
+ *	number of solutions below it, so a state reached again through a different order of placements isn't searched twice.
+ *
+ *	A state is identified by two independent hash words (key picks the slot, check confirms it), so a wrong hit needs both
+ *	of them to collide.
+ *	Counts are kept as unsigned longs to keep slots small, so only counts up to MEMO_MAX_COUNT are stored (larger subtrees
+ *	are rare, and searching them again costs little next to their size).
+ *	The table has a fixed number of slots, set by a memory budget. A key may sit in any of MEMO_WAYS slots starting at
+ *	it's home slot, and when all of them are taken one is replaced by the clock policy: every slot has a reference bit
+ *	set by every hit, and the first slot found without it is replaced (clearing the bits of the slots passed on the way,
+ *	so they are replaced next time unless hit again).
+ *
+ *  Created on: Jul 27, 2019
+ *      Author: Edanz
+ */
+
+#ifndef MEMO_H_
+#define MEMO_H_
+
+#define MEMO_WAYS 4 /*slots a key may be stored in*/
+#define MEMO_MAX_COUNT 0xFFFFFFFFUL /*largest count stored, fits in any unsigned long*/
+
+typedef struct S_memoEntry{
+	unsigned long key;
+	unsigned long check;
+	unsigned long count; /*solutions below the state*/
+	int used; /*1 if the slot holds a state*/
+	int ref; /*clock reference bit*/
+} memoEntry;
+
+typedef struct S_memoTable{
+	memoEntry* slots;
+	unsigned long size; /*number of slots*/
+	unsigned long lookups, hits, stores, evictions;
+} memoTable;
+
+/*
+ * Allocates a table with as many slots as fit in megabytes MB (at least MEMO_WAYS).
+ */
+void initMemo(memoTable* t, int megabytes);
+
+/*
+ * Frees the slots of table t.
+ */
+void freeMemo(memoTable* t);
+
+/*
+ * If the state (key, check) is in table t, sets count to it's count and returns 1, otherwise returns 0.
+ */
+int memoGet(memoTable* t, unsigned long key, unsigned long check, unsigned long* count);
+
+/*
+ * Stores count (at most MEMO_MAX_COUNT) as the count of state (key, check) in table t, replacing another state if needed.
+ */
+void memoPut(memoTable* t, unsigned long key, unsigned long check, unsigned long count);
+
+/*
+ * Prints the hit rate and usage of table t.
+ */
+void printMemoStats(memoTable* t);
+
+#endif /* MEMO_H_ */
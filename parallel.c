@@ -0,0 +1,364 @@
+/*
+ * parallel.c
+ *
+ *	Work stealing thread pool for counting solutions. See header for the general idea.
+ *
+ *	Every worker owns a deque of tasks (a task is a copy of the board with some of the empty cells filled).
+ *	A worker takes tasks from the bottom of it's own deque (newest first, so it keeps working on the same part of the
+ *	tree), and when it's deque is empty it steals from the top of another worker's deque (oldest first, which are the
+ *	biggest sub trees left).
+ *
+ *	A task that is still shallow is split: the empty cell with the fewest options is chosen and a child task is created
+ *	for each of it's options. Deeper tasks are counted by the single threaded engine.
+ *	As the children of a task are pushed to the deque of the worker that split it, idle workers end up stealing from
+ *	the top levels of the tree, and splitting those further themselves.
+ *
+ *	The pool keeps track of the number of tasks that were created and not finished yet (pending), the count is done
+ *	when it reaches 0. Idle workers sleep on a condition variable until a task is pushed, or the count is done.
+ *
+ *  Created on: Jul 10, 2019
+ *      Author: Edanz
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "solver.h"
+#include "parallel.h"
+#include "geometry.h"
+
+#define MIN_SPLIT_DEPTH 3 /*tasks are split at least this deep into the tree, more levels are added for more threads*/
+
+typedef struct S_task{
+	int* board;
+	int depth; /*number of cells filled by splitting*/
+} task;
+
+typedef struct S_deque{
+	task** items;
+	int top; /*index of oldest task*/
+	int bottom; /*index after the newest task*/
+	int cap;
+	pthread_mutex_t lock;
+} deque;
+
+struct S_pool;
+
+typedef struct S_worker{
+	int id;
+	int* options; /*private buffer for findOptions*/
+	deque tasks;
+	struct S_pool* pool;
+} worker;
+
+typedef struct S_pool{
+	worker* workers;
+	int threads;
+	int blockW;
+	int blockH;
+	int splitDepth;
+	countFunc count;
+	int limit;
+	bigNum* total; /*solutions counted so far, by all workers*/
+	int stop; /*set once total reaches limit*/
+	int pending; /*tasks created and not finished yet*/
+	int available; /*tasks waiting in deques*/
+	pthread_mutex_t lock; /*protects pending, available, total and stop*/
+	pthread_cond_t wake;
+} pool;
+
+void* workerMain(void* arg);
+task* getTask(worker* w);
+void runTask(worker* w, task* t);
+void splitTask(worker* w, task* t, int cell, int num);
+void countTask(worker* w, task* t);
+void finishTask(pool* p);
+void pushTask(worker* w, task* t);
+task* popBottom(deque* d);
+task* popTop(deque* d);
+task* newTask(int* board, int size, int depth);
+void freeTask(task* t);
+
+/*
+ * Adds the number of different possible solutions for board b to total, counting on threads worker threads.
+ * Every sub-board created by splitting the board is counted with count.
+ * If limit > 0, all workers stop once total reaches limit.
+ *
+ * The whole board is pushed as the first task to worker 0, all other workers start by stealing.
+ * Once the pool is stopped, the tasks left in the deques are still taken, but only freed.
+ */
+void parallelCount(int* b, int blockW, int blockH, int threads, int limit, bigNum* total, countFunc count){
+	pool p;
+	pthread_t* ids;
+	int i, size = blockW*blockH*blockW*blockH;
+	p.threads = threads;
+	p.blockW = blockW;
+	p.blockH = blockH;
+	p.count = count;
+	p.limit = limit;
+	p.total = total;
+	p.stop = (limit > 0 && bigAtLeast(total, limit));
+	p.pending = 1;
+	p.available = 0;
+	p.splitDepth = MIN_SPLIT_DEPTH;
+	for (i = 1 ; i < threads ; i *= 2){ /*one more level for every doubling of threads*/
+		p.splitDepth++;
+	}
+	pthread_mutex_init(&p.lock, NULL);
+	pthread_cond_init(&p.wake, NULL);
+	assert((p.workers = (worker*) calloc(threads, sizeof(worker)))!=NULL && "Memory allocation error");
+	assert((ids = (pthread_t*) malloc(threads*sizeof(pthread_t)))!=NULL && "Memory allocation error");
+	for (i = 0 ; i < threads ; i++){
+		p.workers[i].id = i;
+		p.workers[i].pool = &p;
+		assert((p.workers[i].options = (int*) malloc(blockW*blockH*sizeof(int)))!=NULL && "Memory allocation error");
+		p.workers[i].tasks.top = 0;
+		p.workers[i].tasks.bottom = 0;
+		p.workers[i].tasks.cap = 16;
+		assert((p.workers[i].tasks.items = (task**) malloc(16*sizeof(task*)))!=NULL && "Memory allocation error");
+		pthread_mutex_init(&p.workers[i].tasks.lock, NULL);
+	}
+	pushTask(&p.workers[0], newTask(b, size, 0));
+	getGeometry(blockW, blockH); /*build the layout's tables before the workers use them, building isn't thread safe*/
+	for (i = 0 ; i < threads ; i++){
+		assert(pthread_create(&ids[i], NULL, workerMain, &p.workers[i])==0 && "Thread creation error");
+	}
+	for (i = 0 ; i < threads ; i++){
+		pthread_join(ids[i], NULL);
+		free(p.workers[i].options);
+		free(p.workers[i].tasks.items);
+		pthread_mutex_destroy(&p.workers[i].tasks.lock);
+	}
+	pthread_mutex_destroy(&p.lock);
+	pthread_cond_destroy(&p.wake);
+	free(p.workers);
+	free(ids);
+}
+
+/*
+ * Main loop of every worker thread: take a task (own or stolen) and run it, until all tasks are finished.
+ */
+void* workerMain(void* arg){
+	worker* w = (worker*) arg;
+	task* t;
+	while ((t = getTask(w)) != NULL){
+		runTask(w, t);
+	}
+	return NULL;
+}
+
+/*
+ * Returns the next task for worker w, or NULL if all work is done.
+ * Looks in the worker's own deque first, then tries to steal from the others in turn.
+ * If no task is found anywhere but some are still running (and might be split), waits until a task is pushed.
+ */
+task* getTask(worker* w){
+	pool* p = w->pool;
+	task* t;
+	int i;
+	while (1){
+		t = popBottom(&w->tasks);
+		for (i = 1 ; t == NULL && i < p->threads ; i++){
+			t = popTop(&(p->workers[(w->id + i) % p->threads].tasks));
+		}
+		pthread_mutex_lock(&p->lock);
+		if (t != NULL){
+			p->available--;
+			pthread_mutex_unlock(&p->lock);
+			return t;
+		}
+		while (p->available == 0 && p->pending > 0){
+			pthread_cond_wait(&p->wake, &p->lock);
+		}
+		if (p->pending == 0){
+			pthread_mutex_unlock(&p->lock);
+			return NULL;
+		}
+		pthread_mutex_unlock(&p->lock);
+	}
+}
+
+/*
+ * Runs a single task: splits it if it's still shallow, otherwise counts it's solutions with the pool's engine.
+ * Cells with a single option are filled in place before choosing where to split, as splitting them gains nothing.
+ * Tasks taken after the pool was stopped are dropped.
+ */
+void runTask(worker* w, task* t){
+	pool* p = w->pool;
+	int dim = p->blockW*p->blockH, size = dim*dim, i, num, best = 0, bestNum = 0, stop;
+	pthread_mutex_lock(&p->lock);
+	stop = p->stop;
+	pthread_mutex_unlock(&p->lock);
+	if (stop){
+		freeTask(t);
+		finishTask(p);
+		return;
+	}
+	while (t->depth < p->splitDepth && best >= 0 && bestNum <= 1){
+		best = -1;
+		bestNum = dim + 1;
+		for (i = 0 ; i < size && bestNum > 1 ; i++){ /*find the empty cell with fewest options*/
+			if (t->board[i] == 0 && (num = findOptions(t->board, i, w->options, p->blockW, p->blockH)) < bestNum){
+				best = i;
+				bestNum = num;
+			}
+		}
+		if (best >= 0 && bestNum == 0){ /*dead end, this task has no solutions*/
+			freeTask(t);
+			finishTask(p);
+			return;
+		}
+		if (best >= 0 && bestNum == 1){
+			findOptions(t->board, best, w->options, p->blockW, p->blockH);
+			t->board[best] = w->options[0];
+		}
+	}
+	if (t->depth < p->splitDepth && best >= 0){
+		splitTask(w, t, best, bestNum);
+		return;
+	}
+	countTask(w, t);
+}
+
+/*
+ * Counts the solutions of task t with the pool's engine, and adds them to the pool's total.
+ * With a limit, the engine is only asked for the solutions still missing to reach it.
+ */
+void countTask(worker* w, task* t){
+	pool* p = w->pool;
+	int left = 0, stop = 0;
+	bigNum found;
+	bigSet(&found, 0);
+	if (p->limit > 0){
+		pthread_mutex_lock(&p->lock);
+		stop = p->stop;
+		if (!stop){
+			left = p->limit - bigToInt(p->total); /*total is below limit, so it fits in an int*/
+		}
+		pthread_mutex_unlock(&p->lock);
+	}
+	if (stop){
+		freeTask(t);
+		finishTask(p);
+		return;
+	}
+	p->count(t->board, p->blockW, p->blockH, left, &found);
+	pthread_mutex_lock(&p->lock);
+	bigAdd(p->total, &found);
+	if (p->limit > 0 && bigAtLeast(p->total, p->limit)){
+		p->stop = 1;
+	}
+	pthread_mutex_unlock(&p->lock);
+	freeTask(t);
+	finishTask(p);
+}
+
+/*
+ * Replaces task t with a child task for each of the num options of cell, pushed to w's deque.
+ */
+void splitTask(worker* w, task* t, int cell, int num){
+	pool* p = w->pool;
+	int i, size = p->blockW*p->blockH*p->blockW*p->blockH;
+	task* child;
+	findOptions(t->board, cell, w->options, p->blockW, p->blockH);
+	pthread_mutex_lock(&p->lock);
+	p->pending += num; /*before t is finished, so pending can't drop to 0 in the meantime*/
+	pthread_mutex_unlock(&p->lock);
+	for (i = 0 ; i < num ; i++){
+		child = newTask(t->board, size, t->depth + 1);
+		child->board[cell] = w->options[i];
+		pushTask(w, child);
+	}
+	freeTask(t);
+	finishTask(p);
+}
+
+/*
+ * Marks a task as finished, and wakes all workers if it was the last one.
+ */
+void finishTask(pool* p){
+	pthread_mutex_lock(&p->lock);
+	p->pending--;
+	if (p->pending == 0){
+		pthread_cond_broadcast(&p->wake);
+	}
+	pthread_mutex_unlock(&p->lock);
+}
+
+/*
+ * Pushes t to the bottom of w's deque and wakes an idle worker to steal it.
+ */
+void pushTask(worker* w, task* t){
+	deque* d = &w->tasks;
+	pthread_mutex_lock(&d->lock);
+	if (d->bottom == d->cap){
+		if (d->top > 0){ /*reuse space freed by stolen tasks*/
+			memmove(d->items, d->items + d->top, (d->bottom - d->top)*sizeof(task*));
+			d->bottom -= d->top;
+			d->top = 0;
+		}
+		else{
+			d->cap *= 2;
+			assert((d->items = (task**) realloc(d->items, d->cap*sizeof(task*)))!=NULL && "Memory allocation error");
+		}
+	}
+	d->items[d->bottom] = t;
+	d->bottom++;
+	pthread_mutex_unlock(&d->lock);
+	pthread_mutex_lock(&w->pool->lock);
+	w->pool->available++;
+	pthread_cond_signal(&w->pool->wake);
+	pthread_mutex_unlock(&w->pool->lock);
+}
+
+/*
+ * Takes the newest task of deque d (used by it's owner), or returns NULL if empty.
+ */
+task* popBottom(deque* d){
+	task* t = NULL;
+	pthread_mutex_lock(&d->lock);
+	if (d->bottom > d->top){
+		d->bottom--;
+		t = d->items[d->bottom];
+	}
+	pthread_mutex_unlock(&d->lock);
+	return t;
+}
+
+/*
+ * Takes the oldest task of deque d (used by thieves), or returns NULL if empty.
+ */
+task* popTop(deque* d){
+	task* t = NULL;
+	pthread_mutex_lock(&d->lock);
+	if (d->bottom > d->top){
+		t = d->items[d->top];
+		d->top++;
+	}
+	pthread_mutex_unlock(&d->lock);
+	return t;
+}
+
+/*
+ * Creates a task holding a copy of board.
+ */
+task* newTask(int* board, int size, int depth){
+	task* t;
+	assert((t = (task*) malloc(sizeof(task)))!=NULL && "Memory allocation error");
+	assert((t->board = (int*) malloc(size*sizeof(int)))!=NULL && "Memory allocation error");
+	memcpy(t->board, board, size*sizeof(int));
+	t->depth = depth;
+	return t;
+}
+
+/*
+ * frees all space allocated to a task.
+ */
+void freeTask(task* t){
+	free(t->board);
+	free(t);
+}
@@ -0,0 +1,35 @@
+/*
+ * parallel.h
+ *
+ *	Counts solutions on several threads.
+ *
+ *	The top levels of the search tree are split into independent sub-boards (tasks), which are spread between worker
+ *	threads by a work stealing pool. Each worker counts it's tasks with a regular (single threaded) counting engine, on a
+ *	private copy of the board, and the per-worker counts are summed at the end.
+ *
+ *  Created on: Jul 10, 2019
+ *      Author: Edanz
+ */
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include "bigNum.h"
+
+/*
+ * A single threaded counting engine. Adds the number of solutions of board b to count, stopping once count reaches limit
+ * (or searching exhaustively if limit <= 0). Must not change the board it receives.
+ */
+typedef void (*countFunc)(int* b, int blockW, int blockH, int limit, bigNum* count);
+
+/*
+ * Adds the number of different possible solutions for board b to total, counting on threads worker threads.
+ * Every sub-board created by splitting the board is counted with count.
+ * If limit > 0, all workers stop once total reaches limit (total may end up somewhat above it).
+ *
+ * Receives board in 1d array form (not modified), block sizes, number of threads, the limit and the counting engine.
+ * Assumes legal board size and matching block sizes, and that threads is positive.
+ */
+void parallelCount(int* b, int blockW, int blockH, int threads, int limit, bigNum* total, countFunc count);
+
+#endif /* PARALLEL_H_ */
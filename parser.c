@@ -35,7 +35,7 @@ int tokNum(char* command);
  *				9.	redo -  Edit and Solve modes
  *				10.	save X -  Edit and Solve modes
  *				11.	hint X Y - only available in Solve mode
- *				12.	num_solutions - Edit and Solve modes
+ *				12.	num_solutions [K] - Edit and Solve modes
  *				13.	autofill - only available in Solve mode
  *				14.	reset - only available in Edit and Solve modes
  *				15.	exit
@@ -84,6 +84,9 @@ void parse(char* command, int res[], mode m, char* fileName){
 	res[1] = getNum(strtok(NULL," \t\r\n"));
 	res[2] = getNum(strtok(NULL," \t\r\n"));
 	res[3] = getNum(strtok(NULL," \t\r\n"));
+	if (res[0]==12 && tmp==2 && res[1]<0){ /*a limit was given, but it's not a number*/
+		res[1] = 0;
+	}
 	return;
 }
 
@@ -157,7 +160,7 @@ int legalArgs(int res, int tmp){
 			break;
 			}
 			case 2:{
-				if ((res<4 || res==10)){
+				if ((res<4 || res==10 || res==12)){
 					return 1;
 				}
 			break;
@@ -0,0 +1,180 @@
+/*
+ * portfolio.c
+ *
+ *	Races engines on threads, see header for the general idea.
+ *
+ *	The caller waits until there is a winner (or all racers failed), sets the stop flag and then joins every racer, so no
+ *	racer is left running once the answer is returned: the engines share the geometry tables, the caches and the GUROBI
+ *	environment with the rest of the program, which might free or change them right after. Waiting for the losers is
+ *	cheap, as they give up once they notice the stop flag (though an engine that checks it only between long steps, such
+ *	as the deductions made before the ILP, might take a little while).
+ *	The stop flag is only ever changed once, from 0 to 1, so the engines poll it without taking the lock.
+ *
+ *  Created on: Jul 24, 2019
+ *      Author: Edanz
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <pthread.h>
+#include "portfolio.h"
+#include "backend.h"
+#include "settings.h"
+#include "geometry.h"
+
+struct S_race;
+
+typedef struct S_racer{
+	engine e;
+	int* board; /*private copy of the board*/
+	pthread_t thread;
+	struct S_race* race;
+} racer;
+
+typedef struct S_race{
+	racer* racers;
+	int num;
+	int blockW;
+	int blockH;
+	int* start; /*the caller's warm start, or NULL*/
+	int winner; /*index of the first racer to answer, -1 if none did yet*/
+	int result; /*the winner's answer*/
+	int finished; /*number of racers done*/
+	volatile int stop; /*set once there is a winner*/
+	pthread_mutex_t lock; /*protects all of the above (stop is only read without it)*/
+	pthread_cond_t done; /*signaled when there is a winner, or all racers finished*/
+} race;
+
+void* racerMain(void* arg);
+void freeRace(race* r);
+double nowMs(void);
+
+/*
+ * Races the engines chosen in settings on board b (see header).
+ * Engines without a solve operation, auto and portfolio itself are never raced. If no engine is left, auto solves alone.
+ */
+int portfolioSolve(int* b, int blockw, int blockh, int* start, volatile int* stop){
+	static int wins[NUM_ENGINES];
+	race* r;
+	int e, i, size = blockw*blockh*blockw*blockh, res;
+	double began = nowMs(), wonMs;
+	(void) stop;
+	getGeometry(blockw, blockh); /*built before the threads start, they only read it*/
+	assert((r = (race*) malloc(sizeof(race)))!=NULL && "Memory allocation error");
+	assert((r->racers = (racer*) malloc(NUM_ENGINES*sizeof(racer)))!=NULL && "Memory allocation error");
+	r->num = 0;
+	r->blockW = blockw;
+	r->blockH = blockh;
+	r->start = start;
+	r->winner = -1;
+	r->result = -1;
+	r->finished = 0;
+	r->stop = 0;
+	for (e = 0 ; e < NUM_ENGINES ; e++){
+		if (!(getSettings()->racers & (1 << e)) || e == engineAuto || e == enginePortfolio || getBackend((engine) e)->solve == NULL){
+			continue;
+		}
+		r->racers[r->num].e = (engine) e;
+		r->racers[r->num].race = r;
+		assert((r->racers[r->num].board = (int*) malloc(size*sizeof(int)))!=NULL && "Memory allocation error");
+		memcpy(r->racers[r->num].board, b, size*sizeof(int));
+		r->num++;
+	}
+	if (r->num == 0){
+		free(r->racers);
+		free(r);
+		return getBackend(engineAuto)->solve(b, blockw, blockh, start, NULL);
+	}
+	pthread_mutex_init(&r->lock, NULL);
+	pthread_cond_init(&r->done, NULL);
+	for (i = 0 ; i < r->num ; i++){
+		assert(pthread_create(&r->racers[i].thread, NULL, racerMain, &r->racers[i])==0 && "Thread creation error");
+	}
+	pthread_mutex_lock(&r->lock);
+	while (r->winner < 0 && r->finished < r->num){
+		pthread_cond_wait(&r->done, &r->lock);
+	}
+	r->stop = 1; /*already set if there is a winner*/
+	pthread_mutex_unlock(&r->lock);
+	wonMs = nowMs() - began;
+	for (i = 0 ; i < r->num ; i++){ /*the losers give up once they see the stop flag*/
+		pthread_join(r->racers[i].thread, NULL);
+	}
+	res = r->result;
+	if (r->winner >= 0){
+		if (res == 1){
+			memcpy(b, r->racers[r->winner].board, size*sizeof(int)); /*the winner is done with it's board*/
+		}
+		wins[r->racers[r->winner].e]++;
+		if (getSettings()->stats){
+			printf("portfolio: %s won in %.2f ms (wins so far:", getBackend(r->racers[r->winner].e)->name, wonMs);
+			for (e = 0 ; e < NUM_ENGINES ; e++){
+				if (wins[e] > 0){
+					printf(" %s %d", getBackend((engine) e)->name, wins[e]);
+				}
+			}
+			printf(")\n");
+		}
+	}
+	else if (getSettings()->stats){
+		printf("portfolio: all engines failed\n");
+	}
+	freeRace(r);
+	return res;
+}
+
+/*
+ * Finds a value for cell index of board b by racing engines (see header).
+ */
+int portfolioHint(int* b, int index, int blockw, int blockh, volatile int* stop){
+	int res = portfolioSolve(b, blockw, blockh, NULL, stop);
+	return (res == 1) ? b[index] : res;
+}
+
+/*
+ * Thread function of a racer: solves it's copy of the board, and if it's answer is the first definitive one, makes it the
+ * winner and stops everyone else.
+ */
+void* racerMain(void* arg){
+	racer* me = (racer*) arg;
+	race* r = me->race;
+	int res = getBackend(me->e)->solve(me->board, r->blockW, r->blockH, r->start, &r->stop);
+	pthread_mutex_lock(&r->lock);
+	if (res >= 0 && r->winner < 0){
+		r->winner = me - r->racers;
+		r->result = res;
+		r->stop = 1;
+	}
+	r->finished++;
+	pthread_cond_signal(&r->done);
+	pthread_mutex_unlock(&r->lock);
+	return NULL;
+}
+
+/*
+ * Frees race r, once all of it's racers were joined.
+ */
+void freeRace(race* r){
+	int i;
+	for (i = 0 ; i < r->num ; i++){
+		free(r->racers[i].board);
+	}
+	free(r->racers);
+	pthread_mutex_destroy(&r->lock);
+	pthread_cond_destroy(&r->done);
+	free(r);
+}
+
+/*
+ * Returns the current time in milliseconds (of a clock that only moves forward).
+ */
+double nowMs(void){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return 1000.0*t.tv_sec + t.tv_nsec/1000000.0;
+}
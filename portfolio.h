@@ -0,0 +1,35 @@
+/*
+ * portfolio.h
+ *
+ *	Solves boards by racing several engines (see backend.h) against each other, as the fastest engine for a board is hard to
+ *	tell in advance: it depends on how constrained the board is much more than on it's size.
+ *
+ *	Every engine chosen in settings gets it's own thread and it's own copy of the board. The first engine to reach a
+ *	definitive answer (a solution, or a proof there is none) wins, and sets a stop flag that all the other engines check
+ *	regularly, so they give up soon after. The losers are waited for before the answer is returned, so no engine is left
+ *	running on shared state once the race is over. Engines that fail (such as GUROBI without a license) are ignored.
+ *	With SUDOKU_STATS on, the winner and it's time are printed, along with the number of races every engine won so far.
+ *
+ *  Created on: Jul 24, 2019
+ *      Author: Edanz
+ */
+
+#ifndef PORTFOLIO_H_
+#define PORTFOLIO_H_
+
+/*
+ * Returns 1 if board b is solvable and fills it with the solution of the winning engine, 0 if the winner found there is
+ * no solution, or -1 if all engines failed.
+ * Receives the board in 1d array form and block sizes. Assumes the board is valid.
+ * start is either NULL or a warm start handed to every engine (see backend.h).
+ * stop is only there to fit the solve operation of a backend, the race itself is never stopped from outside.
+ */
+int portfolioSolve(int* b, int blockw, int blockh, int* start, volatile int* stop);
+
+/*
+ * Returns a value for cell index of board b that keeps it solvable, taken from the solution of the winning engine, 0 if
+ * the board has no solution, or -1 if all engines failed. Same arguments as portfolioSolve, without start.
+ */
+int portfolioHint(int* b, int index, int blockw, int blockh, volatile int* stop);
+
+#endif /* PORTFOLIO_H_ */
@@ -0,0 +1,498 @@
+/*
+ * propagate.c
+ *
+ *	Constraint propagation. See header for the techniques.
+ *
+ *	The board is seen as 3*dim units (dim rows, then dim columns, then dim blocks, see geometry.h), each holding dim cells.
+ *	Filling a cell removes it's value from the candidates of all it's peers (cells sharing a unit with it), and any
+ *	empty cell left without candidates, or value left without a place in some unit, is a contradiction.
+ *
+ *	The cheap techniques are tried first, and every time one of them changes something we go back to the singles,
+ *	so the more expensive subset searches only run when everything cheaper is exhausted.
+ *
+ *  Created on: Jul 14, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "solver.h"
+#include "propagate.h"
+#include "geometry.h"
+
+#define CONTRADICTION -1
+#define NO_CHANGE 0
+#define CHANGED 1
+
+typedef struct S_propState{
+	int* b;
+	bitmask* cand; /*candidates of every empty cell, 0 for filled cells*/
+	geometry* g;
+	int* units; /*units[u*dim + k] is the k'th cell of unit u (the geometry's table)*/
+	int dim;
+	int size;
+	bitmask full;
+	propStats* stats;
+} propState;
+
+int initProp(propState* p, int* b, bitmask* cands, int blockW, int blockH, propStats* stats);
+int placeVal(propState* p, int cell, bitmask bit, technique t);
+int eliminate(propState* p, int cell, bitmask vals, technique t);
+int singles(propState* p);
+int hiddenSingles(propState* p, int u);
+int intersections(propState* p);
+int elimOutside(propState* p, int target, int exclude, bitmask bit, technique t);
+int inUnit(propState* p, int cell, int u);
+int nakedSubsets(propState* p, int k);
+int hiddenSubsets(propState* p, int k);
+int nextComb(int* comb, int k, int n);
+int valOf(bitmask bit);
+
+/*
+ * Applies all techniques on board b until no more deductions can be made.
+ * Returns 0 if a contradiction was found (the board has no solution), 1 otherwise.
+ *
+ * Boards with more than MAX_BIT_DIM values are not propagated.
+ */
+int propagate(int* b, bitmask* cands, int blockW, int blockH, propStats* stats){
+	propState p;
+	int res = NO_CHANGE;
+	if (blockW*blockH > MAX_BIT_DIM){
+		return 1;
+	}
+	if (initProp(&p, b, cands, blockW, blockH, stats)){
+		while (1){
+			if (p.stats != NULL){
+				p.stats->rounds++;
+			}
+			if ((res = singles(&p)) != NO_CHANGE || (res = intersections(&p)) != NO_CHANGE
+					|| (res = nakedSubsets(&p, 2)) != NO_CHANGE || (res = hiddenSubsets(&p, 2)) != NO_CHANGE
+					|| (res = nakedSubsets(&p, 3)) != NO_CHANGE || (res = hiddenSubsets(&p, 3)) != NO_CHANGE){
+				if (res == CONTRADICTION){
+					break;
+				}
+				continue; /*something changed, start over from the singles*/
+			}
+			break;
+		}
+	}
+	else{
+		res = CONTRADICTION;
+	}
+	if (cands == NULL){
+		free(p.cand);
+	}
+	return (res != CONTRADICTION);
+}
+
+/*
+ * Sets all counters of stats to 0.
+ */
+void clearPropStats(propStats* stats){
+	int i;
+	for (i = 0 ; i < numTechniques ; i++){
+		stats->cells[i] = 0;
+		stats->elims[i] = 0;
+	}
+	stats->rounds = 0;
+}
+
+/*
+ * Prints the cells filled and candidates removed by every technique.
+ */
+void printPropStats(propStats* stats){
+	char* names[] = {"naked single", "hidden single", "naked pair", "hidden pair", "naked triple", "hidden triple",
+			"pointing pair", "box-line reduction"};
+	int i;
+	printf("propagation (%d rounds):\n", stats->rounds);
+	for (i = 0 ; i < numTechniques ; i++){
+		printf("\t%-20s %6d cells %6d candidates removed\n", names[i], stats->cells[i], stats->elims[i]);
+	}
+}
+
+/*
+ * Finds the candidates of every empty cell.
+ * Returns 0 if some empty cell has no candidates at all.
+ */
+int initProp(propState* p, int* b, bitmask* cands, int blockW, int blockH, propStats* stats){
+	int dim = blockW*blockH, size = dim*dim, i, res = 1;
+	bitmask *rows;
+	geometry* g = getGeometry(blockW, blockH);
+	p->b = b;
+	p->g = g;
+	p->units = g->units;
+	p->dim = dim;
+	p->size = size;
+	p->stats = stats;
+	p->full = (dim == MAX_BIT_DIM) ? ~((bitmask) 0) : ((((bitmask) 1) << dim) - 1);
+	p->cand = cands;
+	if (cands == NULL){
+		assert((p->cand = (bitmask*) malloc(size*sizeof(bitmask)))!=NULL && "Memory allocation error");
+	}
+	assert((rows = (bitmask*) calloc(3*dim, sizeof(bitmask)))!=NULL && "Memory allocation error");
+	for (i = 0 ; i < size ; i++){ /*rows[u] holds the values already placed in unit u*/
+		if (b[i] != 0){
+			rows[g->rowOf[i]] |= ((bitmask) 1) << (b[i] - 1);
+			rows[dim + g->colOf[i]] |= ((bitmask) 1) << (b[i] - 1);
+			rows[2*dim + g->blockOf[i]] |= ((bitmask) 1) << (b[i] - 1);
+		}
+	}
+	for (i = 0 ; i < size ; i++){
+		p->cand[i] = 0;
+		if (b[i] == 0){
+			p->cand[i] = p->full & ~(rows[g->rowOf[i]] | rows[dim + g->colOf[i]] | rows[2*dim + g->blockOf[i]]);
+			if (p->cand[i] == 0){
+				res = 0;
+			}
+		}
+	}
+	free(rows);
+	return res;
+}
+
+/*
+ * Places value bit in cell (a deduction of technique t), and removes it from the candidates of all peers.
+ * Returns 0 if that leaves a peer without candidates.
+ */
+int placeVal(propState* p, int cell, bitmask bit, technique t){
+	int i, *peer = p->g->peers + cell*p->g->numPeers, res = 1;
+	p->b[cell] = valOf(bit);
+	p->cand[cell] = 0;
+	if (p->stats != NULL){
+		p->stats->cells[t]++;
+	}
+	for (i = 0 ; i < p->g->numPeers ; i++){
+		if (p->b[peer[i]] == 0 && (p->cand[peer[i]] & bit)){
+			p->cand[peer[i]] ^= bit;
+			if (p->cand[peer[i]] == 0){
+				res = 0;
+			}
+		}
+	}
+	return res;
+}
+
+/*
+ * Removes the values in vals from the candidates of cell (a deduction of technique t).
+ * Returns CONTRADICTION if no candidates are left, CHANGED if some were removed, NO_CHANGE otherwise.
+ */
+int eliminate(propState* p, int cell, bitmask vals, technique t){
+	bitmask removed = p->cand[cell] & vals;
+	if (p->b[cell] != 0 || removed == 0){
+		return NO_CHANGE;
+	}
+	p->cand[cell] ^= removed;
+	if (p->stats != NULL){
+		p->stats->elims[t] += bitNum(removed);
+	}
+	return (p->cand[cell] == 0) ? CONTRADICTION : CHANGED;
+}
+
+/*
+ * Fills all naked singles, then all hidden singles of every unit.
+ */
+int singles(propState* p){
+	int i, res = NO_CHANGE, tmp;
+	for (i = 0 ; i < p->size ; i++){
+		if (p->b[i] == 0 && (p->cand[i] & (p->cand[i] - 1)) == 0){ /*at most one candidate*/
+			if (p->cand[i] == 0 || !placeVal(p, i, p->cand[i], nakedSingle)){
+				return CONTRADICTION;
+			}
+			res = CHANGED;
+		}
+	}
+	for (i = 0 ; i < 3*p->dim ; i++){
+		if ((tmp = hiddenSingles(p, i)) == CONTRADICTION){
+			return CONTRADICTION;
+		}
+		if (tmp == CHANGED){
+			res = CHANGED;
+		}
+	}
+	return res;
+}
+
+/*
+ * Fills the values of unit u that have a single possible cell in it.
+ * A value that is neither placed in the unit nor a candidate of any of it's cells is a contradiction.
+ */
+int hiddenSingles(propState* p, int u){
+	int dim = p->dim, k, cell, n, where = 0, res = NO_CHANGE;
+	bitmask seen = 0, twice = 0, placed = 0, once, bit;
+	for (k = 0 ; k < dim ; k++){
+		cell = p->units[u*dim + k];
+		if (p->b[cell] != 0){
+			placed |= ((bitmask) 1) << (p->b[cell] - 1);
+		}
+		else{
+			twice |= seen & p->cand[cell];
+			seen |= p->cand[cell];
+		}
+	}
+	if ((seen | placed) != p->full){
+		return CONTRADICTION;
+	}
+	once = seen & ~twice & ~placed;
+	for ( ; once != 0 ; once ^= bit){
+		bit = once & (~once + 1);
+		n = 0;
+		for (k = 0 ; k < dim ; k++){ /*placing previous singles might have changed the unit, so look again*/
+			cell = p->units[u*dim + k];
+			if (p->b[cell] == valOf(bit)){
+				n = -1;
+				break;
+			}
+			if (p->b[cell] == 0 && (p->cand[cell] & bit)){
+				n++;
+				where = cell;
+			}
+		}
+		if (n == 0){
+			return CONTRADICTION;
+		}
+		if (n == 1){
+			if (!placeVal(p, where, bit, hiddenSingle)){
+				return CONTRADICTION;
+			}
+			res = CHANGED;
+		}
+	}
+	return res;
+}
+
+/*
+ * Pointing pairs and box-line reduction: for every unit and value whose candidate cells in the unit all lie in the same
+ * other unit, removes the value from the rest of that other unit.
+ * Blocks are checked against rows and columns (pointing), rows and columns against blocks (box-line).
+ */
+int intersections(propState* p){
+	int dim = p->dim, u, k, cell, n, r = 0, c = 0, bl = 0, sameR, sameC, sameB, res = NO_CHANGE, tmp;
+	bitmask bit;
+	for (u = 0 ; u < 3*dim ; u++){
+		for (bit = 1 ; bit != 0 && (bit & p->full) ; bit <<= 1){
+			n = 0;
+			sameR = sameC = sameB = 1;
+			for (k = 0 ; k < dim ; k++){
+				cell = p->units[u*dim + k];
+				if (p->b[cell] != 0 || !(p->cand[cell] & bit)){
+					continue;
+				}
+				if (n == 0){
+					r = p->g->rowOf[cell];
+					c = p->g->colOf[cell];
+					bl = p->g->blockOf[cell];
+				}
+				else{
+					sameR = sameR && (p->g->rowOf[cell] == r);
+					sameC = sameC && (p->g->colOf[cell] == c);
+					sameB = sameB && (p->g->blockOf[cell] == bl);
+				}
+				n++;
+			}
+			if (n < 2){ /*left for the singles*/
+				continue;
+			}
+			tmp = NO_CHANGE;
+			if (u >= 2*dim){
+				if (sameR){
+					tmp = elimOutside(p, r, u, bit, pointingPair);
+				}
+				else if (sameC){
+					tmp = elimOutside(p, dim + c, u, bit, pointingPair);
+				}
+			}
+			else if (sameB){
+				tmp = elimOutside(p, 2*dim + bl, u, bit, boxLine);
+			}
+			if (tmp == CONTRADICTION){
+				return CONTRADICTION;
+			}
+			if (tmp == CHANGED){
+				res = CHANGED;
+			}
+		}
+	}
+	return res;
+}
+
+/*
+ * Removes value bit from all cells of unit target that are not in unit exclude.
+ */
+int elimOutside(propState* p, int target, int exclude, bitmask bit, technique t){
+	int k, cell, res = NO_CHANGE, tmp;
+	for (k = 0 ; k < p->dim ; k++){
+		cell = p->units[target*p->dim + k];
+		if (inUnit(p, cell, exclude)){
+			continue;
+		}
+		if ((tmp = eliminate(p, cell, bit, t)) == CONTRADICTION){
+			return CONTRADICTION;
+		}
+		if (tmp == CHANGED){
+			res = CHANGED;
+		}
+	}
+	return res;
+}
+
+/*
+ * Returns 1 if cell belongs to unit u, 0 otherwise.
+ */
+int inUnit(propState* p, int cell, int u){
+	int dim = p->dim;
+	if (u < dim){
+		return (p->g->rowOf[cell] == u);
+	}
+	if (u < 2*dim){
+		return (p->g->colOf[cell] == u - dim);
+	}
+	return (p->g->blockOf[cell] == u - 2*dim);
+}
+
+/*
+ * Naked subsets of k cells (k is 2 or 3): in every unit, looks for k empty cells whose candidates together are exactly
+ * k values, and removes those values from all other cells of the unit.
+ * Fewer than k values for k cells is a contradiction.
+ */
+int nakedSubsets(propState* p, int k){
+	int dim = p->dim, u, i, j, n, cell, comb[3], cells[MAX_BIT_DIM], res = NO_CHANGE, tmp, num;
+	technique t = (k == 2) ? nakedPair : nakedTriple;
+	bitmask vals;
+	for (u = 0 ; u < 3*dim ; u++){
+		n = 0;
+		for (i = 0 ; i < dim ; i++){ /*only cells with 2..k candidates can take part*/
+			cell = p->units[u*dim + i];
+			num = bitNum(p->cand[cell]);
+			if (p->b[cell] == 0 && num >= 2 && num <= k){
+				cells[n] = cell;
+				n++;
+			}
+		}
+		if (n < k){
+			continue;
+		}
+		for (i = 0 ; i < k ; i++){
+			comb[i] = i;
+		}
+		do{
+			vals = 0;
+			for (i = 0 ; i < k ; i++){
+				vals |= p->cand[cells[comb[i]]];
+			}
+			num = bitNum(vals);
+			if (num < k){
+				return CONTRADICTION;
+			}
+			if (num > k){
+				continue;
+			}
+			for (i = 0 ; i < dim ; i++){
+				cell = p->units[u*dim + i];
+				for (j = 0 ; j < k && cells[comb[j]] != cell ; j++);
+				if (j < k){ /*one of the subset's cells*/
+					continue;
+				}
+				if ((tmp = eliminate(p, cell, vals, t)) == CONTRADICTION){
+					return CONTRADICTION;
+				}
+				if (tmp == CHANGED){
+					res = CHANGED;
+				}
+			}
+		} while (nextComb(comb, k, n));
+	}
+	return res;
+}
+
+/*
+ * Hidden subsets of k values (k is 2 or 3): in every unit, looks for k values whose candidate cells together are exactly
+ * k cells, and removes all other values from those cells.
+ * Fewer than k cells for k values is a contradiction.
+ */
+int hiddenSubsets(propState* p, int k){
+	int dim = p->dim, u, i, j, n, cell, comb[3], res = NO_CHANGE, tmp, num;
+	technique t = (k == 2) ? hiddenPair : hiddenTriple;
+	bitmask pos[MAX_BIT_DIM], vals[MAX_BIT_DIM], where, keep;
+	for (u = 0 ; u < 3*dim ; u++){
+		n = 0;
+		for (j = 0 ; j < dim ; j++){ /*pos[n] is the set of positions in the unit (as bits) where value vals[n] fits*/
+			pos[n] = 0;
+			for (i = 0 ; i < dim ; i++){
+				cell = p->units[u*dim + i];
+				if (p->b[cell] == 0 && (p->cand[cell] & (((bitmask) 1) << j))){
+					pos[n] |= ((bitmask) 1) << i;
+				}
+			}
+			num = bitNum(pos[n]);
+			if (num >= 2 && num <= k){ /*only values with 2..k positions can take part*/
+				vals[n] = ((bitmask) 1) << j;
+				n++;
+			}
+		}
+		if (n < k){
+			continue;
+		}
+		for (i = 0 ; i < k ; i++){
+			comb[i] = i;
+		}
+		do{
+			where = 0;
+			keep = 0;
+			for (i = 0 ; i < k ; i++){
+				where |= pos[comb[i]];
+				keep |= vals[comb[i]];
+			}
+			num = bitNum(where);
+			if (num < k){
+				return CONTRADICTION;
+			}
+			if (num > k){
+				continue;
+			}
+			for (i = 0 ; i < dim ; i++){
+				if (!(where & (((bitmask) 1) << i))){
+					continue;
+				}
+				if ((tmp = eliminate(p, p->units[u*dim + i], ~keep, t)) == CONTRADICTION){
+					return CONTRADICTION;
+				}
+				if (tmp == CHANGED){
+					res = CHANGED;
+				}
+			}
+		} while (nextComb(comb, k, n));
+	}
+	return res;
+}
+
+/*
+ * Moves comb (k increasing indices out of 0..n-1) to the next combination in lexicographic order.
+ * Returns 0 if comb was the last one.
+ */
+int nextComb(int* comb, int k, int n){
+	int i = k - 1, j;
+	while (i >= 0 && comb[i] == n - k + i){
+		i--;
+	}
+	if (i < 0){
+		return 0;
+	}
+	comb[i]++;
+	for (j = i + 1 ; j < k ; j++){
+		comb[j] = comb[j-1] + 1;
+	}
+	return 1;
+}
+
+/*
+ * Returns the value represented by a mask with a single bit.
+ */
+int valOf(bitmask bit){
+	int val = 1;
+	while (bit > 1){
+		bit >>= 1;
+		val++;
+	}
+	return val;
+}
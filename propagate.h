@@ -0,0 +1,66 @@
+/*
+ * propagate.h
+ *
+ *	Logical deductions on a board (constraint propagation), the way a human solver fills a board without guessing.
+ *
+ *	Every empty cell keeps a mask of it's candidates (see bitSolver.h for the bitmask representation). The techniques
+ *	below are applied in turn until none of them changes anything (a fixpoint):
+ *		- naked single: a cell with a single candidate gets that value.
+ *		- hidden single: a value that fits in a single cell of a row / column / block goes in that cell.
+ *		- naked pair / triple: k cells of a unit whose candidates are the same k values, those values can't appear in any
+ *		  other cell of the unit.
+ *		- hidden pair / triple: k values that fit only in the same k cells of a unit, no other value can go in those cells.
+ *		- pointing pair: a value whose cells in a block all lie in one row (column), can't be in that row (column) outside
+ *		  the block.
+ *		- box-line reduction: a value whose cells in a row (column) all lie in one block, can't be in that block outside the
+ *		  row (column).
+ *	Every deduction holds for all solutions of the board, so propagating never changes the solutions of a board, but it
+ *	can find that there are none (a contradiction).
+ *
+ *  Created on: Jul 14, 2019
+ *      Author: Edanz
+ */
+
+#ifndef PROPAGATE_H_
+#define PROPAGATE_H_
+
+#include "bitSolver.h"
+
+typedef enum {nakedSingle, hiddenSingle, nakedPair, hiddenPair, nakedTriple, hiddenTriple, pointingPair, boxLine,
+	numTechniques} technique;
+
+/*
+ * What the deductions achieved, per technique.
+ * cells- number of cells filled by the technique (only singles fill cells).
+ * elims- number of candidates removed by the technique (not counting candidates removed by filling cells).
+ */
+typedef struct S_propStats{
+	int cells[numTechniques];
+	int elims[numTechniques];
+	int rounds; /*number of passes until the fixpoint*/
+} propStats;
+
+/*
+ * Applies all techniques on board b until no more deductions can be made.
+ * Returns 0 if a contradiction was found (the board has no solution), 1 otherwise.
+ *
+ * Receives board in 1d array form, which is filled with every value deduced, an array of candidate masks (one per cell) to
+ * be filled with the candidates left for every empty cell (0 for filled cells), or NULL if they are not needed, block sizes,
+ * and a stats structure that is added to (or NULL).
+ * Assumes legal board size and matching block sizes, and that the board itself is valid.
+ *
+ * Boards with more than MAX_BIT_DIM values are not propagated (1 is returned, and cands is not filled).
+ */
+int propagate(int* b, bitmask* cands, int blockW, int blockH, propStats* stats);
+
+/*
+ * Sets all counters of stats to 0.
+ */
+void clearPropStats(propStats* stats);
+
+/*
+ * Prints the cells filled and candidates removed by every technique.
+ */
+void printPropStats(propStats* stats);
+
+#endif /* PROPAGATE_H_ */
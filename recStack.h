@@ -3,6 +3,13 @@
  *
  *	Auxilary model for solver. supplies an interface of a pseudo recursion stack that is used in solver module.
  *
+ *	The stack has three interchangeable implementations (backends), chosen when the stack is initialized:
+ *		stackLinked - the original linked stack, every push allocates a node and every pop frees it.
+ *		stackPooled - a linked stack, whose nodes are taken from (and returned to) a free list of nodes allocated in
+ *			advance by initStack.
+ *		stackArray - a pre-allocated array and the index of it's top.
+ *	The pooled and array backends don't touch the heap after initStack, as long as the stack doesn't grow beyond the
+ *	capacity it was initialized with (for the solver, the number of cells in the board plus one).
  *
  *  Created on: Apr 21, 2019
  *      Author: Edanz
@@ -11,6 +18,8 @@
 #ifndef RECSTACK_H_
 #define RECSTACK_H_
 
+typedef enum {stackLinked, stackPooled, stackArray} stackKind;
+
 /*
  * Used as "recursion stack" for exhaustive backtracking.
  * index- index of last modified cell
@@ -21,10 +30,33 @@ typedef struct bullet{
 	struct bullet *prev;
 } node;
 
+/*
+ * kind- backend used by this stack.
+ * cur- top node (linked backends).
+ * unused- free list of nodes (pooled backend), pool- the block they were allocated in.
+ * items- array of indices (array backend), top- number of indices in it.
+ * cap- capacity the stack was initialized with.
+ */
 typedef struct magazine{
+	stackKind kind;
 	node* cur;
+	node* unused;
+	node* pool;
+	int* items;
+	int top;
+	int cap;
 } stack;
 
+/*
+ * Initializes an empty stack using backend kind, pre-allocating room for capacity entries (ignored by stackLinked).
+ */
+void initStack (stack* s, int capacity, stackKind kind);
+
+/*
+ * Frees all space allocated to stack s (including entries that were not popped).
+ */
+void freeStack (stack* s);
+
 /*
  * Documents another move in the recursion stack: index is the last cell we tried to modify
  */
@@ -32,6 +64,7 @@ void push (stack* s, int index);
 
 /*
  * Returns the index of previous modified cell, frees the topmost node, and changes the top pointer in stack to be new top.
+ * Returns -1 if the stack is empty.
  */
 int pop (stack* s);
 
@@ -0,0 +1,762 @@
+/*
+ * sat.c
+ *
+ *	CDCL SAT solver and the Sudoku encoding for it. See header for the general idea.
+ *
+ *	Literals are numbered 2*var (true) and 2*var+1 (negated). Clauses are kept one after the other in a single int array
+ *	(the arena): a header of CLAUSE_HEADER ints (size, learnt flag, LBD) followed by the literals, and are referred to by
+ *	their offset in the arena. The two first literals of every clause (with at least two literals) are it's watches, and
+ *	watches[l] lists the clauses watching literal l, which are visited when l becomes false.
+ *	The literal a clause implied is always it's first, so conflict analysis can skip it in the reason clause.
+ *
+ *	Clauses are only removed on restarts, at decision level 0: learnt clauses with a high LBD are dropped, clauses
+ *	satisfied at level 0 are dropped and literals false at level 0 are removed, then the arena is compacted and all watch
+ *	lists are built again.
+ *
+ *  Created on: Jul 19, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "sat.h"
+#include "map.h"
+#include "ILP.h"
+#include "geometry.h"
+#include "settings.h"
+
+#define LIT(var, neg) (2*(var) + (neg))
+#define VAR(lit) ((lit) >> 1)
+#define NOT(lit) ((lit) ^ 1)
+#define LIT_VALUE(s, lit) (((lit) & 1) ? -(s)->val[(lit) >> 1] : (s)->val[(lit) >> 1]) /*1 true, -1 false, 0 unassigned*/
+#define NO_REASON (-1)
+#define CLAUSE_HEADER 3
+#define PAIRWISE_MAX 6 /*"at most one" of up to this many variables is encoded pairwise*/
+#define RESTART_BASE 100 /*conflicts between restarts are multiples of this*/
+#define VAR_DECAY 0.95
+#define MAX_LBD 64
+
+typedef struct S_watchList{
+	int* refs;
+	int len;
+	int cap;
+} watchList;
+
+typedef struct S_cdcl{
+	int numVars;
+	int numClauses; /*original clauses*/
+	int unsat; /*an empty clause was added*/
+	signed char* val; /*value of every variable: 1 true, -1 false, 0 unassigned*/
+	signed char* phase; /*last value of every variable*/
+	char* seen; /*marks variables during conflict analysis*/
+	int* level; /*decision level every variable was assigned at*/
+	int* reason; /*clause that implied every variable, NO_REASON for decisions and level 0*/
+	double* activity;
+	double varInc;
+	int* heap; /*unassigned variables (and maybe some assigned ones), as a max heap by activity*/
+	int* heapPos; /*position of every variable in heap, -1 if it's not there*/
+	int heapLen;
+	int* trail; /*assigned literals, in order*/
+	int trailLen;
+	int qhead; /*trail[qhead..] were not propagated yet*/
+	int* trailLim; /*trailLim[d] is the trail length when decision level d+1 started*/
+	int numLevels; /*current decision level*/
+	int* arena;
+	int arenaLen;
+	int arenaCap;
+	int numLearnt;
+	int maxLearnt;
+	watchList* watches; /*2*numVars lists*/
+	int* learnt; /*clause learnt from the last conflict, and a copy of it's literals before minimization*/
+	int* levelStamp; /*for counting the levels of a clause*/
+	int stamp;
+	long conflicts;
+	long decisions;
+	long propagations;
+	int restarts;
+	volatile int* stop; /*NULL, or a flag that ends the search once it's set*/
+} cdcl;
+
+int satEncode(int* b, map* m, int dim, int blockw, int blockh, cdcl* s, int* nextVar);
+void satExactlyOne(cdcl* s, int* vars, int n, int* lits, int* nextVar);
+void cdclInit(cdcl* s, int numVars);
+void cdclFree(cdcl* s);
+void cdclAddClause(cdcl* s, int* lits, int n);
+int cdclStore(cdcl* s, int* lits, int n, int learnt, int lbd);
+void watchPush(watchList* w, int ref);
+int cdclSolve(cdcl* s);
+void cdclEnqueue(cdcl* s, int lit, int reason);
+int cdclPropagate(cdcl* s);
+int cdclAnalyze(cdcl* s, int confl, int* btLevel, int* lbd);
+int cdclRedundant(cdcl* s, int var);
+void cdclBacktrack(cdcl* s, int lvl);
+int cdclDecide(cdcl* s);
+void cdclReduce(cdcl* s);
+void cdclBump(cdcl* s, int var);
+void cdclHeapInsert(cdcl* s, int var);
+int cdclHeapPop(cdcl* s);
+void cdclHeapUp(cdcl* s, int pos);
+void cdclHeapDown(cdcl* s, int pos);
+int cdclLuby(int i);
+
+/*
+ * Solves board b with the SAT solver, and writes the solution to sol (see header).
+ * The encoding is done twice: first only to count the helper variables of the sequential counters, so the solver can be
+ * allocated once, then to add the clauses.
+ */
+int SAT(int* b, map* m, double* sol, int dim, int blockw, int blockh, double* start, volatile int* stop){
+	int total = GetNumVar(m), numVars = total, i, res;
+	cdcl s;
+	if (satEncode(b, m, dim, blockw, blockh, NULL, &numVars) != 0){ /*some value can't be placed in some unit*/
+		return -1;
+	}
+	cdclInit(&s, numVars);
+	numVars = total;
+	satEncode(b, m, dim, blockw, blockh, &s, &numVars);
+	s.stop = stop;
+	for (i = 0 ; start != NULL && i < total ; i++){ /*the values of start are decided first, and decided true*/
+		if (start[i] > 0.5){
+			s.phase[i] = 1;
+			cdclBump(&s, i);
+		}
+	}
+	res = cdclSolve(&s);
+	if (getSettings()->stats){
+		printf("sat solver: %d variables, %d clauses, %ld conflicts, %ld decisions, %ld propagations, %d restarts\n",
+				s.numVars, s.numClauses, s.conflicts, s.decisions, s.propagations, s.restarts);
+	}
+	for (i = 0 ; res == 1 && i < total ; i++){
+		sol[i] = (s.val[i] == 1) ? 1.0 : 0.0;
+	}
+	cdclFree(&s);
+	if (res < 0){
+		return SOLVE_STOPPED;
+	}
+	return (res ? 0 : -1);
+}
+
+/*
+ * Adds the Sudoku constraints on the map's variables to solver s: every cell with variables gets exactly one of them, and
+ * every value missing from a row, column or block is placed exactly once in it.
+ * Helper variables are numbered from *nextVar on, which is advanced past them.
+ * If s is NULL, only advances *nextVar (counts helper variables).
+ *
+ * Returns -1 if some value can't be placed anywhere in a unit it's missing from (no solution), 0 otherwise.
+ */
+int satEncode(int* b, map* m, int dim, int blockw, int blockh, cdcl* s, int* nextVar){
+	geometry* g = getGeometry(blockw, blockh);
+	int i, k, v, u, num, first, var, *vars, *lits, *present, res = 0;
+	assert((vars = (int*) malloc(3*dim*sizeof(int)))!=NULL && "Memory allocation error");
+	lits = vars + dim; /*clause buffer, "exactly one" of n variables needs at most n literals*/
+	present = lits + dim;
+	for (i = 0 ; i < g->size ; i++){
+		num = GetNumCell(m, i);
+		first = GetFirstVar(m, i);
+		for (k = 0 ; k < num ; k++){
+			vars[k] = first + k;
+		}
+		if (num > 0){
+			satExactlyOne(s, vars, num, lits, nextVar);
+		}
+	}
+	for (u = 0 ; u < 3*dim && res == 0 ; u++){
+		for (v = 0 ; v < dim ; v++){
+			present[v] = 0;
+		}
+		for (k = 0 ; k < dim ; k++){
+			i = g->units[u*dim + k];
+			if (b[i] != 0){
+				present[b[i] - 1] = 1;
+			}
+		}
+		for (v = 0 ; v < dim && res == 0 ; v++){
+			if (present[v]){
+				continue;
+			}
+			num = 0;
+			for (k = 0 ; k < dim ; k++){
+				i = g->units[u*dim + k];
+				if ((var = getMapping(m, i, v + 1)) >= 0){
+					vars[num] = var;
+					num++;
+				}
+			}
+			if (num == 0){
+				res = -1;
+			}
+			else{
+				satExactlyOne(s, vars, num, lits, nextVar);
+			}
+		}
+	}
+	free(vars);
+	return res;
+}
+
+/*
+ * Adds clauses saying exactly one of the n variables in vars is true, using lits as a clause buffer (of n literals).
+ * Small groups get all pairwise "not both" clauses, bigger ones a sequential counter: helper variable s_k is true if
+ * one of the first k+1 variables is, and a variable can't be true once an earlier one was.
+ * If s is NULL, only advances *nextVar by the number of helper variables.
+ */
+void satExactlyOne(cdcl* s, int* vars, int n, int* lits, int* nextVar){
+	int i, j, aux = *nextVar;
+	if (n > PAIRWISE_MAX){
+		*nextVar += n - 1;
+	}
+	if (s == NULL){
+		return;
+	}
+	for (i = 0 ; i < n ; i++){
+		lits[i] = LIT(vars[i], 0);
+	}
+	cdclAddClause(s, lits, n);
+	if (n <= PAIRWISE_MAX){
+		for (i = 0 ; i < n ; i++){
+			for (j = i + 1 ; j < n ; j++){
+				lits[0] = LIT(vars[i], 1);
+				lits[1] = LIT(vars[j], 1);
+				cdclAddClause(s, lits, 2);
+			}
+		}
+		return;
+	}
+	for (i = 0 ; i < n ; i++){ /*helper s_i is variable aux + i*/
+		if (i < n - 1){ /*x_i -> s_i*/
+			lits[0] = LIT(vars[i], 1);
+			lits[1] = LIT(aux + i, 0);
+			cdclAddClause(s, lits, 2);
+		}
+		if (i > 0){ /*s_(i-1) -> not x_i*/
+			lits[0] = LIT(aux + i - 1, 1);
+			lits[1] = LIT(vars[i], 1);
+			cdclAddClause(s, lits, 2);
+		}
+		if (i > 0 && i < n - 1){ /*s_(i-1) -> s_i*/
+			lits[0] = LIT(aux + i - 1, 1);
+			lits[1] = LIT(aux + i, 0);
+			cdclAddClause(s, lits, 2);
+		}
+	}
+}
+
+/*
+ * Initializes an empty solver with numVars variables, all unassigned.
+ */
+void cdclInit(cdcl* s, int numVars){
+	int i;
+	s->numVars = numVars;
+	s->numClauses = 0;
+	s->unsat = 0;
+	assert((s->val = (signed char*) calloc(2*numVars + 1, sizeof(signed char)))!=NULL && "Memory allocation error");
+	s->phase = s->val + numVars;
+	assert((s->level = (int*) malloc((9*numVars + 2)*sizeof(int)))!=NULL && "Memory allocation error");
+	s->reason = s->level + numVars;
+	s->heap = s->reason + numVars;
+	s->heapPos = s->heap + numVars;
+	s->trail = s->heapPos + numVars;
+	s->trailLim = s->trail + numVars;
+	s->learnt = s->trailLim + numVars;
+	s->levelStamp = s->learnt + 2*numVars + 1; /*levels 0..numVars*/
+	assert((s->seen = (char*) calloc(numVars + 1, sizeof(char)))!=NULL && "Memory allocation error");
+	assert((s->activity = (double*) calloc(numVars + 1, sizeof(double)))!=NULL && "Memory allocation error");
+	assert((s->watches = (watchList*) calloc(2*numVars + 1, sizeof(watchList)))!=NULL && "Memory allocation error");
+	s->varInc = 1.0;
+	s->heapLen = 0;
+	for (i = 0 ; i < numVars ; i++){
+		s->phase[i] = -1; /*try false first, most variables of a Sudoku are false*/
+		s->reason[i] = NO_REASON;
+		s->levelStamp[i] = 0;
+		s->heapPos[i] = -1;
+		cdclHeapInsert(s, i);
+	}
+	s->levelStamp[numVars] = 0;
+	s->stamp = 0;
+	s->trailLen = 0;
+	s->qhead = 0;
+	s->numLevels = 0;
+	s->arenaCap = 1024;
+	s->arenaLen = 0;
+	assert((s->arena = (int*) malloc(s->arenaCap*sizeof(int)))!=NULL && "Memory allocation error");
+	s->numLearnt = 0;
+	s->maxLearnt = 0;
+	s->conflicts = 0;
+	s->decisions = 0;
+	s->propagations = 0;
+	s->restarts = 0;
+	s->stop = NULL;
+}
+
+/*
+ * Frees all space allocated to solver s.
+ */
+void cdclFree(cdcl* s){
+	int i;
+	for (i = 0 ; i < 2*s->numVars ; i++){
+		free(s->watches[i].refs);
+	}
+	free(s->watches);
+	free(s->val);
+	free(s->seen);
+	free(s->level);
+	free(s->activity);
+	free(s->arena);
+}
+
+/*
+ * Adds an original clause of n literals (at decision level 0, before solving).
+ * Literals already false are dropped and satisfied clauses are skipped, a unit clause is assigned right away.
+ */
+void cdclAddClause(cdcl* s, int* lits, int n){
+	int i, j = 0;
+	for (i = 0 ; i < n ; i++){
+		if (LIT_VALUE(s, lits[i]) == 1){
+			return;
+		}
+		if (LIT_VALUE(s, lits[i]) == 0){
+			lits[j] = lits[i];
+			j++;
+		}
+	}
+	s->numClauses++;
+	if (j == 0){
+		s->unsat = 1;
+	}
+	else if (j == 1){
+		cdclEnqueue(s, lits[0], NO_REASON);
+	}
+	else{
+		cdclStore(s, lits, j, 0, 0);
+	}
+}
+
+/*
+ * Copies a clause of n >= 2 literals to the arena, watches it's first two literals, and returns it's reference.
+ */
+int cdclStore(cdcl* s, int* lits, int n, int learnt, int lbd){
+	int ref = s->arenaLen;
+	while (s->arenaLen + CLAUSE_HEADER + n > s->arenaCap){
+		s->arenaCap *= 2;
+		assert((s->arena = (int*) realloc(s->arena, s->arenaCap*sizeof(int)))!=NULL && "Memory allocation error");
+	}
+	s->arena[ref] = n;
+	s->arena[ref + 1] = learnt;
+	s->arena[ref + 2] = lbd;
+	memcpy(s->arena + ref + CLAUSE_HEADER, lits, n*sizeof(int));
+	s->arenaLen += CLAUSE_HEADER + n;
+	watchPush(&s->watches[lits[0]], ref);
+	watchPush(&s->watches[lits[1]], ref);
+	return ref;
+}
+
+/*
+ * Adds clause ref to watch list w.
+ */
+void watchPush(watchList* w, int ref){
+	if (w->len == w->cap){
+		w->cap = (w->cap == 0) ? 4 : 2*w->cap;
+		assert((w->refs = (int*) realloc(w->refs, w->cap*sizeof(int)))!=NULL && "Memory allocation error");
+	}
+	w->refs[w->len] = ref;
+	w->len++;
+}
+
+/*
+ * Searches for an assignment satisfying all clauses. Returns 1 if one was found (it's left in s->val), 0 if there is none,
+ * or -1 if s->stop was set (it's checked on every conflict and decision).
+ *
+ * Restarts (going back to level 0, keeping the learnt clauses and activities) are made after Luby sequence multiples of
+ * RESTART_BASE conflicts. They're only made once propagation found no conflict, so level 0 is fully propagated when the
+ * learnt clauses are reduced.
+ */
+int cdclSolve(cdcl* s){
+	int confl, n, btLevel, lbd;
+	long restartAt = RESTART_BASE;
+	if (s->unsat){
+		return 0;
+	}
+	s->maxLearnt = s->numClauses/3 + 1000;
+	while (1){
+		if (s->stop != NULL && *s->stop){
+			return -1;
+		}
+		confl = cdclPropagate(s);
+		if (confl != NO_REASON){
+			s->conflicts++;
+			if (s->numLevels == 0){
+				return 0;
+			}
+			n = cdclAnalyze(s, confl, &btLevel, &lbd);
+			cdclBacktrack(s, btLevel);
+			if (n == 1){
+				cdclEnqueue(s, s->learnt[0], NO_REASON);
+			}
+			else{
+				cdclEnqueue(s, s->learnt[0], cdclStore(s, s->learnt, n, 1, lbd));
+				s->numLearnt++;
+			}
+			s->varInc /= VAR_DECAY;
+			continue;
+		}
+		if (s->conflicts >= restartAt){
+			s->restarts++;
+			restartAt = s->conflicts + (long) RESTART_BASE*cdclLuby(s->restarts + 1);
+			cdclBacktrack(s, 0);
+			if (s->numLearnt >= s->maxLearnt){
+				cdclReduce(s);
+				s->maxLearnt += s->maxLearnt/10;
+			}
+		}
+		if (!cdclDecide(s)){
+			return 1;
+		}
+	}
+}
+
+/*
+ * Assigns literal lit (makes it true) at the current decision level, implied by clause reason.
+ */
+void cdclEnqueue(cdcl* s, int lit, int reason){
+	int v = VAR(lit);
+	s->val[v] = (lit & 1) ? -1 : 1;
+	s->level[v] = s->numLevels;
+	s->reason[v] = reason;
+	s->trail[s->trailLen] = lit;
+	s->trailLen++;
+}
+
+/*
+ * Propagates all assignments not propagated yet. Returns the reference of a conflicting clause (all literals false),
+ * or NO_REASON if there is no conflict.
+ *
+ * For every clause watching a literal that became false: if it's other watch is true nothing is done, otherwise a new
+ * non false literal is looked for to watch instead. If there is none, the clause is unit (it's other watch is implied)
+ * or conflicting.
+ */
+int cdclPropagate(cdcl* s){
+	int p, falseLit, i, j, k, ref, size, *lits, confl = NO_REASON;
+	watchList* ws;
+	while (s->qhead < s->trailLen && confl == NO_REASON){
+		p = s->trail[s->qhead];
+		s->qhead++;
+		s->propagations++;
+		falseLit = NOT(p);
+		ws = &s->watches[falseLit];
+		for (i = 0, j = 0 ; i < ws->len ; i++){
+			ref = ws->refs[i];
+			size = s->arena[ref];
+			lits = s->arena + ref + CLAUSE_HEADER;
+			if (lits[0] == falseLit){ /*keep the false watch second*/
+				lits[0] = lits[1];
+				lits[1] = falseLit;
+			}
+			if (LIT_VALUE(s, lits[0]) == 1){
+				ws->refs[j] = ref;
+				j++;
+				continue;
+			}
+			for (k = 2 ; k < size && LIT_VALUE(s, lits[k]) == -1 ; k++){
+			}
+			if (k < size){ /*move the watch*/
+				lits[1] = lits[k];
+				lits[k] = falseLit;
+				watchPush(&s->watches[lits[1]], ref);
+				continue;
+			}
+			ws->refs[j] = ref;
+			j++;
+			if (LIT_VALUE(s, lits[0]) == -1){
+				confl = ref;
+				for (i++ ; i < ws->len ; i++){ /*keep the rest of the watches*/
+					ws->refs[j] = ws->refs[i];
+					j++;
+				}
+				s->qhead = s->trailLen;
+			}
+			else{
+				cdclEnqueue(s, lits[0], ref);
+			}
+		}
+		ws->len = j;
+	}
+	return confl;
+}
+
+/*
+ * Analyzes conflicting clause confl, and leaves the clause learnt from it in s->learnt, returning it's size.
+ * The learnt clause has the negation of the first unique implication point as it's first literal, and the literal of the
+ * highest level among the rest second (so the clause is unit after backtracking to that level, which is put in btLevel).
+ * lbd is set to the number of distinct decision levels in the clause.
+ *
+ * Literals implied by other literals of the clause (their reason has no other literals) are removed.
+ */
+int cdclAnalyze(cdcl* s, int confl, int* btLevel, int* lbd){
+	int pathC = 0, p = -1, idx = s->trailLen - 1, n = 1, i, j, k, v, q, size, *lits, *copy = s->learnt + s->numVars + 1;
+	do{
+		size = s->arena[confl];
+		lits = s->arena + confl + CLAUSE_HEADER;
+		for (k = (p == -1) ? 0 : 1 ; k < size ; k++){ /*the first literal of a reason is p itself*/
+			q = lits[k];
+			v = VAR(q);
+			if (!s->seen[v] && s->level[v] > 0){
+				cdclBump(s, v);
+				s->seen[v] = 1;
+				if (s->level[v] >= s->numLevels){
+					pathC++;
+				}
+				else{
+					s->learnt[n] = q;
+					n++;
+				}
+			}
+		}
+		while (!s->seen[VAR(s->trail[idx])]){ /*last seen literal on the trail*/
+			idx--;
+		}
+		p = s->trail[idx];
+		idx--;
+		confl = s->reason[VAR(p)];
+		s->seen[VAR(p)] = 0;
+		pathC--;
+	} while (pathC > 0);
+	s->learnt[0] = NOT(p);
+	memcpy(copy, s->learnt, n*sizeof(int));
+	for (i = 1, j = 1 ; i < n ; i++){
+		if (s->reason[VAR(s->learnt[i])] == NO_REASON || !cdclRedundant(s, VAR(s->learnt[i]))){
+			s->learnt[j] = s->learnt[i];
+			j++;
+		}
+	}
+	for (i = 1 ; i < n ; i++){
+		s->seen[VAR(copy[i])] = 0;
+	}
+	n = j;
+	*btLevel = 0;
+	for (i = 2 ; i < n ; i++){ /*highest level literal goes second*/
+		if (s->level[VAR(s->learnt[i])] > s->level[VAR(s->learnt[1])]){
+			q = s->learnt[1];
+			s->learnt[1] = s->learnt[i];
+			s->learnt[i] = q;
+		}
+	}
+	if (n > 1){
+		*btLevel = s->level[VAR(s->learnt[1])];
+	}
+	s->stamp++;
+	for (i = 0, *lbd = 0 ; i < n ; i++){
+		if (s->levelStamp[s->level[VAR(s->learnt[i])]] != s->stamp){
+			s->levelStamp[s->level[VAR(s->learnt[i])]] = s->stamp;
+			(*lbd)++;
+		}
+	}
+	return n;
+}
+
+/*
+ * Returns 1 if all the other literals of the reason of var are in the learnt clause (seen) or false at level 0.
+ */
+int cdclRedundant(cdcl* s, int var){
+	int ref = s->reason[var], k, size = s->arena[ref], *lits = s->arena + ref + CLAUSE_HEADER;
+	for (k = 1 ; k < size ; k++){
+		if (!s->seen[VAR(lits[k])] && s->level[VAR(lits[k])] > 0){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * Undoes all assignments above decision level lvl, saving their values as phases.
+ */
+void cdclBacktrack(cdcl* s, int lvl){
+	int i, v;
+	if (s->numLevels <= lvl){
+		return;
+	}
+	for (i = s->trailLen - 1 ; i >= s->trailLim[lvl] ; i--){
+		v = VAR(s->trail[i]);
+		s->phase[v] = s->val[v];
+		s->val[v] = 0;
+		s->reason[v] = NO_REASON;
+		if (s->heapPos[v] < 0){
+			cdclHeapInsert(s, v);
+		}
+	}
+	s->trailLen = s->trailLim[lvl];
+	s->qhead = s->trailLen;
+	s->numLevels = lvl;
+}
+
+/*
+ * Starts a new decision level, assigning the unassigned variable of highest activity it's saved phase.
+ * Returns 0 if all variables are assigned, 1 otherwise.
+ */
+int cdclDecide(cdcl* s){
+	int v = -1;
+	while (s->heapLen > 0 && v < 0){
+		v = cdclHeapPop(s);
+		if (s->val[v] != 0){
+			v = -1;
+		}
+	}
+	if (v < 0){
+		return 0;
+	}
+	s->decisions++;
+	s->trailLim[s->numLevels] = s->trailLen;
+	s->numLevels++;
+	cdclEnqueue(s, LIT(v, s->phase[v] != 1), NO_REASON);
+	return 1;
+}
+
+/*
+ * Removes about half of the learnt clauses (those with the highest LBD, clauses with LBD 2 or less are always kept), and
+ * simplifies the rest with the level 0 assignments. Must be called at level 0, after propagation.
+ * As every clause left has at least two unassigned literals, it's first two literals can be watched again.
+ */
+void cdclReduce(cdcl* s){
+	int hist[MAX_LBD + 1], keep, limit = MAX_LBD, kept = 0, ref, w = 0, size, learnt, lbd, i, j, drop, *lits;
+	for (i = 0 ; i <= MAX_LBD ; i++){
+		hist[i] = 0;
+	}
+	for (ref = 0 ; ref < s->arenaLen ; ref += CLAUSE_HEADER + s->arena[ref]){
+		if (s->arena[ref + 1]){
+			hist[(s->arena[ref + 2] > MAX_LBD) ? MAX_LBD : s->arena[ref + 2]]++;
+		}
+	}
+	for (i = 0, keep = 0 ; i <= MAX_LBD ; i++){ /*highest LBD that keeps at most half*/
+		keep += hist[i];
+		if (keep > s->numLearnt/2 && i > 2){
+			limit = i - 1;
+			break;
+		}
+	}
+	for (i = 0 ; i < 2*s->numVars ; i++){
+		s->watches[i].len = 0;
+	}
+	for (i = 0 ; i < s->trailLen ; i++){ /*all assignments are at level 0, and are never analyzed*/
+		s->reason[VAR(s->trail[i])] = NO_REASON;
+	}
+	for (ref = 0 ; ref < s->arenaLen ; ref += CLAUSE_HEADER + size){
+		size = s->arena[ref]; /*the header is read before anything is moved over it*/
+		learnt = s->arena[ref + 1];
+		lbd = s->arena[ref + 2];
+		lits = s->arena + ref + CLAUSE_HEADER;
+		drop = (learnt && lbd > limit);
+		for (i = 0, j = 0 ; i < size && !drop ; i++){
+			if (LIT_VALUE(s, lits[i]) == 1){
+				drop = 1;
+			}
+			else if (LIT_VALUE(s, lits[i]) == 0){
+				lits[j] = lits[i];
+				j++;
+			}
+		}
+		if (drop){
+			continue;
+		}
+		s->arena[w] = j;
+		s->arena[w + 1] = learnt;
+		s->arena[w + 2] = lbd;
+		memmove(s->arena + w + CLAUSE_HEADER, lits, j*sizeof(int));
+		watchPush(&s->watches[s->arena[w + CLAUSE_HEADER]], w);
+		watchPush(&s->watches[s->arena[w + CLAUSE_HEADER + 1]], w);
+		kept += learnt;
+		w += CLAUSE_HEADER + j;
+	}
+	s->arenaLen = w;
+	s->numLearnt = kept;
+}
+
+/*
+ * Raises the activity of var, rescaling all activities if they grow too big.
+ */
+void cdclBump(cdcl* s, int var){
+	int i;
+	s->activity[var] += s->varInc;
+	if (s->activity[var] > 1e100){
+		for (i = 0 ; i < s->numVars ; i++){
+			s->activity[i] *= 1e-100;
+		}
+		s->varInc *= 1e-100;
+	}
+	if (s->heapPos[var] >= 0){
+		cdclHeapUp(s, s->heapPos[var]);
+	}
+}
+
+/*
+ * Adds var to the activity heap.
+ */
+void cdclHeapInsert(cdcl* s, int var){
+	s->heap[s->heapLen] = var;
+	s->heapPos[var] = s->heapLen;
+	s->heapLen++;
+	cdclHeapUp(s, s->heapLen - 1);
+}
+
+/*
+ * Removes and returns the variable of highest activity in the heap. Assumes the heap isn't empty.
+ */
+int cdclHeapPop(cdcl* s){
+	int top = s->heap[0];
+	s->heapLen--;
+	s->heapPos[top] = -1;
+	if (s->heapLen > 0){
+		s->heap[0] = s->heap[s->heapLen];
+		s->heapPos[s->heap[0]] = 0;
+		cdclHeapDown(s, 0);
+	}
+	return top;
+}
+
+/*
+ * Moves the variable at heap position pos up until it's parent is at least as active.
+ */
+void cdclHeapUp(cdcl* s, int pos){
+	int v = s->heap[pos], parent;
+	while (pos > 0 && s->activity[s->heap[(parent = (pos - 1)/2)]] < s->activity[v]){
+		s->heap[pos] = s->heap[parent];
+		s->heapPos[s->heap[pos]] = pos;
+		pos = parent;
+	}
+	s->heap[pos] = v;
+	s->heapPos[v] = pos;
+}
+
+/*
+ * Moves the variable at heap position pos down until both it's children are at most as active.
+ */
+void cdclHeapDown(cdcl* s, int pos){
+	int v = s->heap[pos], child;
+	while ((child = 2*pos + 1) < s->heapLen){
+		if (child + 1 < s->heapLen && s->activity[s->heap[child + 1]] > s->activity[s->heap[child]]){
+			child++;
+		}
+		if (s->activity[s->heap[child]] <= s->activity[v]){
+			break;
+		}
+		s->heap[pos] = s->heap[child];
+		s->heapPos[s->heap[pos]] = pos;
+		pos = child;
+	}
+	s->heap[pos] = v;
+	s->heapPos[v] = pos;
+}
+
+/*
+ * Returns the i'th element (i >= 1) of the Luby sequence 1,1,2,1,1,2,4,1,1,2,...
+ */
+int cdclLuby(int i){
+	int k;
+	while (1){
+		for (k = 1 ; (1 << k) - 1 < i ; k++){
+		}
+		if ((1 << k) - 1 == i){
+			return 1 << (k - 1);
+		}
+		i -= (1 << (k - 1)) - 1;
+	}
+}
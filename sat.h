@@ -0,0 +1,38 @@
+/*
+ * sat.h
+ *
+ *	Solves Sudoku boards with a built in CDCL SAT solver, as an alternative to the GUROBI optimizer of the ILP module
+ *	(it needs no license, and it's usually faster on boards that are left with few variables after propagation).
+ *
+ *	The board is encoded on the variables chosen by the map module (a variable for every candidate of every empty cell):
+ *	every cell gets exactly one of it's variables, and every value appears exactly once in every row, column and block
+ *	it's not already in. "Exactly one" is a clause saying at least one is true, with pairwise "at most one" clauses for a
+ *	few variables, and a sequential counter (a chain of helper variables, linear in the number of variables) for more.
+ *
+ *	The solver itself is a conflict driven clause learning solver: two watched literals per clause, first UIP conflict
+ *	analysis with clause minimization, VSIDS variable activities with phase saving, Luby restarts, and a learnt clause
+ *	database that drops the clauses with the highest LBD (number of decision levels in the clause) on restarts.
+ *
+ *  Created on: Jul 19, 2019
+ *      Author: Edanz
+ */
+
+#ifndef SAT_H_
+#define SAT_H_
+
+#include "map.h"
+
+/*
+ * Solves board b with the SAT solver, and writes the solution to sol in the same form the ILP function does:
+ * sol[v] is 1 if map variable v is true in the solution (the cell gets the value of that variable), 0 otherwise.
+ * Returns 0 if a solution was found, -1 if the board has no solution, or SOLVE_STOPPED (ILP.h) if stopped by stop.
+ *
+ * Receives an array representing the board, an initialized map (see map.h), array for solution (of the map's number of
+ * variables), block dimensions, a warm start (see mapSolver in ILP.h) or NULL, and either NULL or a flag that makes the
+ * solver give up once it's set (by another thread).
+ * The variables set in the warm start are decided first, and decided true, so the search starts at the warm start and
+ * only moves away from it where it conflicts.
+ */
+int SAT(int* b, map* m, double* sol, int dim, int blockw, int blockh, double* start, volatile int* stop);
+
+#endif /* SAT_H_ */
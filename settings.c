@@ -0,0 +1,247 @@
+/*
+ * settings.c
+ *
+ *	Keeps the program's settings and reads their overrides from the environment.
+ *	See header for the list of supported environment variables.
+ *
+ *  Created on: Jul 5, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "settings.h"
+#include "bitSolver.h"
+#include "backend.h"
+#include "sizes.h"
+
+#define WORD_LEN 32
+
+int hasWord(const char* list, const char* word);
+void readCountFlags(settings* s);
+void readStack(settings* s);
+void readSimd(settings* s);
+engine readEngine(char* str, engine def);
+void readRacers(settings* s);
+int readPositive(char* str, int def);
+int readRange(char* str, int low, int high, int def);
+int readFlag(char* str, int def);
+
+/*
+ * Returns a pointer to the program's settings.
+ * On first call, initializes them with defaults and applies the environment variables described in the header.
+ */
+settings* getSettings(void){
+	static settings s;
+	static int loaded = 0;
+	if (!loaded){
+		s.countFlags = COUNT_MRV;
+		s.counter = readEngine(getenv("SUDOKU_COUNTER"), engineDlx);
+		s.threads = readPositive(getenv("SUDOKU_THREADS"), 1);
+		readCountFlags(&s);
+		s.counterStack = DEF_STACK;
+		s.propagate = readFlag(getenv("SUDOKU_PROPAGATE"), 1);
+		s.stats = readFlag(getenv("SUDOKU_STATS"), 0);
+		readStack(&s);
+		s.simd = simdAuto;
+		readSimd(&s);
+		s.solver = readEngine(getenv("SUDOKU_SOLVER"), DEF_SOLVER);
+		s.racers = (1 << engineGurobi) | (1 << engineSat) | (1 << engineDlx) | (1 << engineBacktrack);
+		readRacers(&s);
+		s.symmetry = readFlag(getenv("SUDOKU_SYMMETRY"), 1);
+		s.memoSize = readPositive(getenv("SUDOKU_MEMO"), DEF_MEMO_MB);
+		s.cacheSize = readFlag(getenv("SUDOKU_CACHE"), 1) ? readPositive(getenv("SUDOKU_CACHE"), DEF_CACHE_SIZE) : 0;
+		s.diskCache = getenv("SUDOKU_DISK_CACHE");
+		if (s.diskCache != NULL && s.diskCache[0] == '\0'){
+			s.diskCache = NULL;
+		}
+		s.grbThreads = readRange(getenv("SUDOKU_GRB_THREADS"), 0, 4096, DEF_GRB_THREADS);
+		s.grbPresolve = readRange(getenv("SUDOKU_GRB_PRESOLVE"), -1, 2, DEF_GRB_PRESOLVE);
+		s.grbFocus = readRange(getenv("SUDOKU_GRB_FOCUS"), 0, 3, DEF_GRB_FOCUS);
+		s.grbSolutions = readPositive(getenv("SUDOKU_GRB_SOLUTIONS"), 1);
+		s.grbTime = readRange(getenv("SUDOKU_GRB_TIME"), 0, 1000000, 0);
+		s.grbIncremental = readFlag(getenv("SUDOKU_GRB_INCREMENTAL"), 1);
+		s.grbStart = readFlag(getenv("SUDOKU_GRB_START"), 1);
+		loaded = 1;
+	}
+	return &s;
+}
+
+/*
+ * Applies the settings given on the command line (main's arguments).
+ * Returns 1 on success, or 0 if some argument is not recognized.
+ */
+int readArgs(int argc, char* argv[]){
+	settings* s = getSettings();
+	int i;
+	for (i = 1 ; i < argc ; i++){
+		if ((strcmp(argv[i],"-t")==0 || strcmp(argv[i],"--threads")==0) && i+1 < argc){
+			i++;
+			s->threads = readPositive(argv[i], s->threads);
+			continue;
+		}
+		if ((strcmp(argv[i],"-s")==0 || strcmp(argv[i],"--solver")==0) && i+1 < argc){
+			i++;
+			s->solver = readEngine(argv[i], s->solver);
+			continue;
+		}
+		if ((strcmp(argv[i],"-c")==0 || strcmp(argv[i],"--counter")==0) && i+1 < argc){
+			i++;
+			s->counter = readEngine(argv[i], s->counter);
+			continue;
+		}
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * Reads SUDOKU_COUNT (if set) into the counter heuristics.
+ */
+void readCountFlags(settings* s){
+	char* env = getenv("SUDOKU_COUNT");
+	if (env == NULL){
+		return;
+	}
+	s->countFlags = 0;
+	if (hasWord(env,"mrv")){
+		s->countFlags |= COUNT_MRV;
+	}
+	if (hasWord(env,"lcv")){
+		s->countFlags |= COUNT_LCV;
+	}
+	if (hasWord(env,"memo")){
+		s->countFlags |= COUNT_MEMO;
+	}
+}
+
+/*
+ * Reads SUDOKU_STACK (if set) into the recursion stack backend. Unknown names keep the default.
+ */
+void readStack(settings* s){
+	char* env = getenv("SUDOKU_STACK");
+	if (env == NULL){
+		return;
+	}
+	if (hasWord(env,"linked")){
+		s->counterStack = stackLinked;
+	}
+	else if (hasWord(env,"pooled")){
+		s->counterStack = stackPooled;
+	}
+	else if (hasWord(env,"array")){
+		s->counterStack = stackArray;
+	}
+}
+
+/*
+ * Reads SUDOKU_SIMD (if set) into the validator's instruction set. Unknown names keep the default.
+ */
+void readSimd(settings* s){
+	char* env = getenv("SUDOKU_SIMD");
+	if (env == NULL){
+		return;
+	}
+	if (hasWord(env,"scalar")){
+		s->simd = simdScalar;
+	}
+	else if (hasWord(env,"sse2")){
+		s->simd = simdSse2;
+	}
+	else if (hasWord(env,"avx2")){
+		s->simd = simdAvx2;
+	}
+	else if (hasWord(env,"auto")){
+		s->simd = simdAuto;
+	}
+}
+
+/*
+ * Reads SUDOKU_PORTFOLIO (if set) into the engines raced by the portfolio solver.
+ */
+void readRacers(settings* s){
+	char* env = getenv("SUDOKU_PORTFOLIO");
+	int e;
+	if (env == NULL){
+		return;
+	}
+	s->racers = 0;
+	for (e = 0 ; e < NUM_ENGINES ; e++){
+		if (hasWord(env, getBackend((engine) e)->name)){
+			s->racers |= (1 << e);
+		}
+	}
+}
+
+/*
+ * Returns the engine named in str (see backend.h), or def if str is NULL or names no engine.
+ */
+engine readEngine(char* str, engine def){
+	int e;
+	if (str == NULL){
+		return def;
+	}
+	for (e = 0 ; e < NUM_ENGINES ; e++){
+		if (hasWord(str, getBackend((engine) e)->name)){
+			return (engine) e;
+		}
+	}
+	return def;
+}
+
+/*
+ * Returns the positive integer written in str, or def if str is NULL or not a positive integer.
+ */
+int readPositive(char* str, int def){
+	return readRange(str, 1, 4096, def);
+}
+
+/*
+ * Returns the integer written in str, or def if str is NULL or not an integer between low and high.
+ */
+int readRange(char* str, int low, int high, int def){
+	char* end;
+	long val;
+	if (str == NULL){
+		return def;
+	}
+	val = strtol(str, &end, 10);
+	if (end == str || *end != '\0' || val < low || val > high){
+		return def;
+	}
+	return (int) val;
+}
+
+/*
+ * Returns 0 if str is "0", "off" or "no", def if str is NULL, and 1 otherwise.
+ */
+int readFlag(char* str, int def){
+	if (str == NULL){
+		return def;
+	}
+	return !(strcmp(str,"0")==0 || strcmp(str,"off")==0 || strcmp(str,"no")==0);
+}
+
+/*
+ * Returns 1 if word appears as one of the comma (or space) separated words of list, 0 otherwise.
+ */
+int hasWord(const char* list, const char* word){
+	char token[WORD_LEN];
+	int len;
+	while (*list != '\0'){
+		len = strcspn(list,", \t");
+		if (len > 0 && len < WORD_LEN){
+			strncpy(token,list,len);
+			token[len] = '\0';
+			if (strcmp(token,word)==0){
+				return 1;
+			}
+		}
+		list += len;
+		if (*list != '\0'){
+			list++; /*skip the separator*/
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * settings.h
+ *
+ *	Holds the program's tunable settings (choice of algorithms, heuristics etc.) in a single structure.
+ *
+ *	All settings have defaults, which can be overridden by environment variables.
+ *	The environment is read once, the first time the settings are requested.
+ *
+ *		SUDOKU_COUNT - comma separated list of heuristics used when counting solutions:
+ *				"mrv" - branch on the cell with the fewest candidates first (ties broken by degree).
+ *				"lcv" - try the least constraining values of a cell first.
+ *				"static" - neither, cells are filled in order (like num_solutions).
+ *				"memo" - keep the counts of searched states in a transposition table (see COUNT_MEMO in bitSolver.h).
+ *			default: "mrv".
+ *		SUDOKU_COUNTER - engine used to count solutions (num_solutions), one of the engines of the backend module:
+ *				"dlx" - Dancing Links (dlx module).
+ *				"bitmask" - bitmask backtracking (bitSolver module), using the SUDOKU_COUNT heuristics.
+ *				"backtrack" - the original pseudo recursive num_solutions.
+ *				"auto" - chosen by the board (see backend.h).
+ *			Engines that can't count ("gurobi", "sat") count with "dlx".
+ *			default: "dlx".
+ *		SUDOKU_THREADS - number of threads used to count solutions. default: 1.
+ *		SUDOKU_STACK - recursion stack backend used by the "backtrack" counter (see recStack.h):
+ *				"linked" - allocates a node on every push.
+ *				"pooled" - linked, with nodes taken from a pre-allocated free list.
+ *				"array" - pre-allocated array.
+ *			default: DEF_STACK of sizes.h ("array").
+ *		SUDOKU_PROPAGATE - "0" turns off the logical deductions (propagate module) made before solving and counting.
+ *			default: on.
+ *		SUDOKU_STATS - "1" prints statistics of the solvers (such as the cells filled by every deduction technique).
+ *			default: off.
+ *		SUDOKU_SIMD - widest vector instruction set the board validator (errCheck module) may use: "scalar", "sse2", "avx2"
+ *			or "auto". It is lowered further if the cpu doesn't support it.
+ *			default: "auto" (widest supported).
+ *		SUDOKU_SOLVER - engine used to solve boards (validate, hint, generate and the other commands that need a solution), one
+ *			of the engines of the backend module:
+ *				"gurobi" - the GUROBI optimizer (ILP module).
+ *				"sat" - the built in CDCL SAT solver (sat module), needs no license.
+ *				"dlx" - Dancing Links (dlx module).
+ *				"backtrack" - the pseudo recursive search of num_solutions, stopping at the first solution.
+ *				"auto" - chosen by the board's size and number of filled cells (see backend.h).
+ *				"portfolio" - races the SUDOKU_PORTFOLIO engines on their own threads and takes the first answer.
+ *			Engines that can't solve ("bitmask") solve with "auto".
+ *			default: DEF_SOLVER of sizes.h ("auto").
+ *		SUDOKU_PORTFOLIO - comma separated list of the engines raced by the "portfolio" solver. Engines that can't solve
+ *			("bitmask", or "gurobi" when built without GUROBI), "auto" and "portfolio" are skipped.
+ *			default: "gurobi,sat,dlx,backtrack".
+ *		SUDOKU_SYMMETRY - "0" turns off the symmetry reduction (symmetry module) of solution counts with no limit.
+ *			default: on.
+ *		SUDOKU_MEMO - memory budget of the "memo" transposition table, in megabytes. default: DEF_MEMO_MB of sizes.h (16).
+ *		SUDOKU_CACHE - number of board states whose validate / num_solutions results are remembered (stateCache module),
+ *			"0" turns the cache off. default: DEF_CACHE_SIZE of sizes.h (64).
+ *		SUDOKU_DISK_CACHE - path of a file that keeps solved boards across runs (diskCache module), created if missing. Several
+ *			processes may share it. default: none (no disk cache).
+ *		SUDOKU_GRB_THREADS, SUDOKU_GRB_PRESOLVE, SUDOKU_GRB_FOCUS, SUDOKU_GRB_SOLUTIONS, SUDOKU_GRB_TIME - the GUROBI parameters
+ *			Threads (0 lets GUROBI choose), Presolve (-1..2), MIPFocus (0..3), SolutionLimit and TimeLimit (in seconds, 0 for
+ *			none). A board is only ever checked for a solution, so the optimizer stops at the first one it finds.
+ *			defaults: DEF_GRB_THREADS (1), DEF_GRB_PRESOLVE (2) and DEF_GRB_FOCUS (1) of sizes.h, 1 solution, no time limit.
+ *		SUDOKU_GRB_INCREMENTAL - "0" builds a new GUROBI model for every solve, instead of keeping one model and only changing
+ *			the cells that changed since the last solve. default: on.
+ *		SUDOKU_GRB_START - "0" turns off GUROBI's MIP start: the board's last solution if it still agrees with the board,
+ *			or a greedy fill of the board (see ILP.h). Compare the optimizer times of SUDOKU_STATS with it on and off to see
+ *			how much sooner the start leads to the first solution. default: on.
+ *
+ *	Some settings can also be given on the command line (which takes precedence over the environment):
+ *		-t N / --threads N - same as SUDOKU_THREADS.
+ *		-s NAME / --solver NAME - same as SUDOKU_SOLVER.
+ *		-c NAME / --counter NAME - same as SUDOKU_COUNTER.
+ *
+ *  Created on: Jul 5, 2019
+ *      Author: Edanz
+ */
+
+#ifndef SETTINGS_H_
+#define SETTINGS_H_
+
+#include "recStack.h"
+
+/*
+ * Engines that can solve boards and / or count their solutions (see backend.h).
+ */
+typedef enum {engineGurobi, engineSat, engineDlx, engineBitmask, engineBacktrack, engineAuto, enginePortfolio, NUM_ENGINES} engine;
+
+/*
+ * Vector instruction sets, narrowest first.
+ */
+typedef enum {simdScalar, simdSse2, simdAvx2, simdAuto} simdLevel;
+
+typedef struct S_settings{
+	int countFlags; /*heuristics used by the solution counter, COUNT_* flags of bitSolver.h*/
+	engine counter; /*engine used to count solutions*/
+	int threads; /*number of threads used to count solutions*/
+	stackKind counterStack; /*recursion stack backend of num_solutions*/
+	int propagate; /*1 if deductions are made before solving and counting*/
+	int stats; /*1 if solver statistics are printed*/
+	simdLevel simd; /*widest vector instruction set the board validator may use*/
+	engine solver; /*engine used to solve boards*/
+	int racers; /*engines raced by the portfolio solver, bit e is set if engine e is raced*/
+	int symmetry; /*1 if solution counts with no limit are reduced by the board's symmetries*/
+	int memoSize; /*memory budget of the counter's transposition table, in megabytes*/
+	int cacheSize; /*number of board states remembered by the state cache (0 if none)*/
+	char* diskCache; /*path of the on-disk solve cache, NULL if none*/
+	int grbThreads; /*GUROBI parameters: Threads, Presolve, MIPFocus, SolutionLimit and TimeLimit (seconds, 0 if none)*/
+	int grbPresolve;
+	int grbFocus;
+	int grbSolutions;
+	int grbTime;
+	int grbIncremental; /*1 if the GUROBI model is kept between solves (see liveSolve in ILP.h)*/
+	int grbStart; /*1 if GUROBI is given a MIP start (see mapSolver in ILP.h)*/
+} settings;
+
+/*
+ * Returns a pointer to the program's settings.
+ * On first call, initializes them with defaults and applies the environment variables described above.
+ */
+settings* getSettings(void);
+
+/*
+ * Applies the settings given on the command line (main's arguments).
+ * Returns 1 on success, or 0 if some argument is not recognized.
+ */
+int readArgs(int argc, char* argv[]);
+
+#endif /* SETTINGS_H_ */
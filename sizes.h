@@ -12,6 +12,27 @@
 #define DEF_BLOCK_H 3
 #define COMMAND_LEN 256
 #define MAX_GEN_ITERATIONS 1000
+#ifndef DEF_STACK
+#define DEF_STACK stackArray /*recursion stack backend of num_solutions, see recStack.h (can be set with -DDEF_STACK=...)*/
+#endif
+#ifndef DEF_SOLVER
+#define DEF_SOLVER engineAuto /*engine used to solve boards, see backend.h (can be set with -DDEF_SOLVER=...)*/
+#endif
+#ifndef DEF_MEMO_MB
+#define DEF_MEMO_MB 16 /*memory budget of the counter's transposition table in megabytes (can be set with -DDEF_MEMO_MB=...)*/
+#endif
+#ifndef DEF_CACHE_SIZE
+#define DEF_CACHE_SIZE 64 /*number of board states remembered by the state cache (can be set with -DDEF_CACHE_SIZE=...)*/
+#endif
+#ifndef DEF_GRB_THREADS
+#define DEF_GRB_THREADS 1 /*threads used by GUROBI, a Sudoku model is too small to split well (can be set with -DDEF_GRB_THREADS=...)*/
+#endif
+#ifndef DEF_GRB_PRESOLVE
+#define DEF_GRB_PRESOLVE 2 /*GUROBI presolve level, aggressive presolve solves most Sudoku models alone (-DDEF_GRB_PRESOLVE=...)*/
+#endif
+#ifndef DEF_GRB_FOCUS
+#define DEF_GRB_FOCUS 1 /*GUROBI MIPFocus, 1 is finding feasible solutions (can be set with -DDEF_GRB_FOCUS=...)*/
+#endif
 
 
 
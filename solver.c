@@ -16,18 +16,30 @@
 #include <stdlib.h>
 #include <assert.h>
 #include "recStack.h"
+#include "settings.h"
+#include "bigNum.h"
+#include "bitSolver.h"
+#include "geometry.h"
+#include "errCheck.h"
+#include "candSet.h"
 
+void boundedSolutions(int* b, int blockW, int blockH, int limit, bigNum* count);
+int backtrackSolve(int* b, int blockW, int blockH, volatile int* stop);
+int backtrack(int* b, int blockW, int blockH, int limit, bigNum* count, int keep, volatile int* stop);
 int isValidm(int* b, int i, int j, int val, int blockW, int blockH);
-int isValidRm(int* b, int i, int j, int val, int size);
-int isValidCm(int* b, int i, int j, int val, int size);
-int isValidBm(int* b, int i, int j, int val, int blockW, int blockH);
+int isValidAt(int* b, geometry* g, int index, int val);
 int next(int* b, int index, int len);
 int findOptions(int *b,int index,int *options, int blockw, int blockh);
+int findCands(int* b, geometry* g, int index, bitmask* s);
 int isAllValid(int* b, int blockW, int blockH);
+void incrementalAuto(int* b, int blockw, int blockh);
+int translateBlockIndex(int blockNum, int placeInBlock, int blockw, int blockh);
+int getBlockNum(int i, int j, int blockw, int blockh);
+int addPeers(int* b, geometry* g, int cell, int* work, int n, int* mark, int pass);
 
 /*
  * Counts number of solutions possible for current board and Returns
- * number of different possible solutions for current board state (0 if none).
+ * number of different possible solutions for current board state (0 if none, -1 if the count doesn't fit in an int).
  *
  * Receives board in 1d array form and size parameters.
  * Assumes legal board size and matching block sizes.
@@ -41,20 +53,74 @@ int isAllValid(int* b, int blockW, int blockH);
  * a solution to the board. if we reached a cell with no possible valid placements we backtrack to the last edited cell (by using the
  * stack to move back to it) and try a different placement.
  *
+ * The stack is allocated once, before the search, with room for every cell (plus the padding), using the backend chosen in the
+ * settings. With the pooled or array backends, the search itself does no heap allocations at all.
  */
 int num_solutions(int* b, int blockW, int blockH){
-	int counter = 0, index = -1, dim = (blockW)*(blockH), totalLen = (dim*dim), val;
+	bigNum count;
+	bigSet(&count, 0);
+	boundedSolutions(b, blockW, blockH, 0, &count);
+	return bigToInt(&count);
+}
+
+/*
+ * Same search as num_solutions, but adds the number of solutions found to count (which is wide enough not to overflow on
+ * near empty boards), and stops as soon as count reaches limit. Searches exhaustively if limit <= 0.
+ * When stopping early, the cells still on the stack are cleared so the board is left as it was received.
+ */
+void boundedSolutions(int* b, int blockW, int blockH, int limit, bigNum* count){
+	backtrack(b, blockW, blockH, limit, count, 0, NULL);
+}
+
+/*
+ * Returns 1 if board b is solvable and fills it with the first solution found by the num_solutions search, returns 0
+ * (and leaves b unchanged) otherwise, or -1 if stopped by stop (see header).
+ */
+int backtrackSolve(int* b, int blockW, int blockH, volatile int* stop){
+	bigNum count;
+	bigSet(&count, 0);
+	if (backtrack(b, blockW, blockH, 1, &count, 1, stop)){
+		return -1;
+	}
+	return bigAtLeast(&count, 1);
+}
+
+/*
+ * The search of boundedSolutions. If keep is set, the board is left with the last solution found when stopping early.
+ * stop is either NULL, or a flag that ends the search once it's set, leaving the board as it was received.
+ * Returns 1 if the search was stopped this way, 0 otherwise.
+ */
+int backtrack(int* b, int blockW, int blockH, int limit, bigNum* count, int keep, volatile int* stop){
+	int stopped = 0, index = -1, dim = (blockW)*(blockH), totalLen = (dim*dim), val;
+	geometry* g = getGeometry(blockW, blockH);
 	stack s;
+	initStack(&s,totalLen+1,getSettings()->counterStack);
 	push(&s,-1); /*pad the stack with exit value of -1*/
 	index = next(b,index,totalLen); /*looking from index -1 so we won't miss cell 0*/
 	while (index>=0){
+		if (stop != NULL && *stop){ /*index is an empty cell of the original board, or the end of it*/
+			if (index < totalLen){
+				b[index] = 0;
+			}
+			while ((index = pop(&s)) >= 0){
+				b[index] = 0;
+			}
+			stopped = 1;
+			break;
+		}
 		if (index==totalLen){ /*reached end of board with a legal placement*/
-			counter++;
+			bigInc(count);
+			if (limit > 0 && bigAtLeast(count, limit)){
+				while (!keep && (index = pop(&s)) >= 0){ /*undo the placements of the current path*/
+					b[index] = 0;
+				}
+				break;
+			}
 			index = pop(&s);
 			continue; /*skip rest of the iteration*/
 		}
 		val = b[index]+1; /*next value that was not checked for current cell*/
-		while (val<=dim && (!(isValidm(b,(index/dim),(index%dim),val,blockW,blockH)))){ /*find next valid value for current cell*/
+		while (val<=dim && (!(isValidAt(b,g,index,val)))){ /*find next valid value for current cell*/
 			val++;
 		}
 		if (val>dim){ /*no legal placement was found for cell*/
@@ -67,7 +133,8 @@ int num_solutions(int* b, int blockW, int blockH){
 			index = next(b,index,totalLen);
 		}
 	}
-	return counter;
+	freeStack(&s);
+	return stopped;
 }
 
 /*
@@ -77,33 +144,53 @@ int num_solutions(int* b, int blockW, int blockH){
  * ****NOTE THIS FUNCTION RECIEVCES COORDINATES IN ROW MAJOR 0 BASED FORM****
  */
 int isValidm(int* b, int i, int j, int val, int blockW, int blockH){
+	geometry* g = getGeometry(blockW, blockH);
+	return isValidAt(b, g, i*g->dim + j, val);
+}
+
+/*
+ * Same as isValidm, for the cell in index, on a board of geometry g.
+ * The value is valid if none of the cell's peers (same row, column or block) holds it.
+ */
+int isValidAt(int* b, geometry* g, int index, int val){
+	int p, *peer = g->peers + index*g->numPeers;
 	if (val==0){/*always legal to delete a cell*/
 		return 1;
 	}
-	return (isValidRm(b,i,j,val,blockW*blockH) && isValidCm(b,i,j,val,blockW*blockH) && isValidBm(b,i,j,val,blockW,blockH));
+	for (p = 0 ; p < g->numPeers ; p++){
+		if (b[peer[p]]==val){
+			return 0;
+		}
+	}
+	return 1;
 }
 
 /*
  * Fills all obvious placements in board into b1, and returns number of cells filled.
  * Note that this function might result in an erroneous board (which means it's not solvable).
  *
- * Receives three int arrays: b1 representing a board, b2 with the same size, options- of at least maxVal size, and block sizes.
+ * Receives two int arrays: b1 representing a board, b2 with the same size, and block sizes.
  *
  * Assumes all non empty cells of b2 contain the same values as b1.
  *
- * As this function might be called iteratively, it is kept lean and supplied with all the auxilary arrays,
- * to avoid repeated memory allocations (b2, options).
- *
- *
+ * The options of every cell are found as a candidate set (see candSet.h), kept in a local array unless the board is huge.
  */
-int autofill(int* b1, int* b2, int* options, int blockw, int blockh){
-	int i, num = 0, dim = blockw*blockh, size = (dim * dim);
+int autofill(int* b1, int* b2, int blockw, int blockh){
+	int i, num = 0, dim = blockw*blockh, size = (dim * dim), words = CAND_WORDS(dim);
+	bitmask local[CAND_LOCAL_WORDS], *s = local;
+	geometry* g = getGeometry(blockw, blockh);
+	if (words > CAND_LOCAL_WORDS){
+		assert((s = (bitmask*) malloc(words*sizeof(bitmask)))!=NULL && "Memory allocation error");
+	}
 	for (i=0; i<size ; i++){
-		if (b1[i] == 0 && findOptions(b1,i,options, blockw, blockh)==1){ /*empty cell with 1 possible placment*/
-			b2[i] = options[0];
+		if (b1[i] == 0 && findCands(b1,g,i,s)==1){ /*empty cell with 1 possible placment*/
+			b2[i] = candNext(s,words,0);
 			num++;
 		}
 	}
+	if (s != local){
+		free(s);
+	}
 	for (i=0; i<size ; i++){
 		if (b1[i]==0 && b2[i]!=0){
 			b1[i] = b2[i];
@@ -116,35 +203,138 @@ int autofill(int* b1, int* b2, int* options, int blockw, int blockh){
  * Performs autofill moves on the board, until no obvious placements remain.
  * If the result is an erroneous board, returns 0.
  * otherwise returns 1.
+ *
+ * The placements are made by incrementalAuto, which yields exactly the same board as repeated autofill passes.
  */
 int fullAuto(int* b1, int blockw, int blockh){
-	int *b2,*options;
-	assert((b2 = (int*) calloc(blockw*blockh*blockw*blockh, sizeof(int)))!= NULL && "memory allocation error");
-	assert((options = (int*) malloc(blockw* blockh * sizeof(int)))!= NULL && "memory allocation error");
-	while (autofill(b1,b2,options,blockw,blockh)!=0);
-	free(b2);
-	free(options);
+	incrementalAuto(b1, blockw, blockh);
 	return(isAllValid(b1, blockw, blockh));
 }
 
+/*
+ * Makes the same passes as calling autofill until it fills nothing, but only looks at cells that might have changed.
+ *
+ * Every pass finds all the empty cells with a single option, according to the board as it was at the start of the pass,
+ * and only then fills them (so, just like autofill, two cells of a unit may get the same value in one pass).
+ * The options of an empty cell only change when one of it's peers is filled, so a cell that had no peer filled in the
+ * previous pass can't have become a single, and the next pass only checks the peers of the cells just filled (the work
+ * list). The values present in every row, column and block are kept as candidate sets (see candSet.h), so the options of
+ * a cell are found with a couple of ORs per word instead of findOptions.
+ */
+void incrementalAuto(int* b, int blockw, int blockh){
+	int dim = blockw*blockh, size = dim*dim, words = CAND_WORDS(dim), i, w, n = 0, found, pass = 0, single;
+	int *work, *fill, *mark, *vals;
+	bitmask *rows, *cols, *blocks, *full, *r, *c, *k, cand;
+	geometry* g = getGeometry(blockw, blockh);
+	assert((rows = (bitmask*) calloc((3*dim + 1)*words, sizeof(bitmask)))!=NULL && "Memory allocation error");
+	cols = rows + dim*words; /*the set of unit u is the words at u*words*/
+	blocks = cols + dim*words;
+	full = blocks + dim*words;
+	candFill(full, dim);
+	assert((work = (int*) malloc(4*size*sizeof(int)))!=NULL && "Memory allocation error");
+	fill = work + size;
+	mark = fill + size;
+	vals = mark + size;
+	for (i = 0 ; i < size ; i++){
+		mark[i] = 0;
+		if (b[i] == 0){ /*first pass checks all empty cells*/
+			work[n] = i;
+			n++;
+			continue;
+		}
+		candAdd(rows + g->rowOf[i]*words, b[i]);
+		candAdd(cols + g->colOf[i]*words, b[i]);
+		candAdd(blocks + g->blockOf[i]*words, b[i]);
+	}
+	while (n > 0){
+		found = 0;
+		for (i = 0 ; i < n ; i++){
+			r = rows + g->rowOf[work[i]]*words;
+			c = cols + g->colOf[work[i]]*words;
+			k = blocks + g->blockOf[work[i]]*words;
+			single = 0; /*the only option found so far, -1 once there are more*/
+			for (w = 0 ; w < words && single >= 0 ; w++){
+				cand = full[w] & ~(r[w] | c[w] | k[w]);
+				if (cand == 0){
+					continue;
+				}
+				single = (single == 0 && (cand & (cand - 1)) == 0) ? w*MAX_BIT_DIM + lowestBit(cand) + 1 : -1;
+			}
+			if (single > 0){ /*a single option*/
+				fill[found] = work[i];
+				vals[found] = single;
+				found++;
+			}
+		}
+		pass++;
+		n = 0;
+		for (i = 0 ; i < found ; i++){
+			candAdd(rows + g->rowOf[fill[i]]*words, vals[i]);
+			candAdd(cols + g->colOf[fill[i]]*words, vals[i]);
+			candAdd(blocks + g->blockOf[fill[i]]*words, vals[i]);
+			b[fill[i]] = vals[i];
+		}
+		for (i = 0 ; i < found ; i++){
+			n = addPeers(b, g, fill[i], work, n, mark, pass);
+		}
+	}
+	free(rows);
+	free(work);
+}
+
+/*
+ * Adds the empty peers of cell (same row, column or block) to the work list of length n, and returns the new length.
+ * mark[x] == pass for cells already added in this pass, so every cell is added once.
+ */
+int addPeers(int* b, geometry* g, int cell, int* work, int n, int* mark, int pass){
+	int p, *peer = g->peers + cell*g->numPeers;
+	for (p = 0 ; p < g->numPeers ; p++){
+		if (b[peer[p]] == 0 && mark[peer[p]] != pass){
+			mark[peer[p]] = pass;
+			work[n] = peer[p];
+			n++;
+		}
+	}
+	return n;
+}
 
 /*
  * Finds all valid assignments to cell (index), stores them in options array and returns number of options.
  * Receives array representing board, cell index, array to store options output and block sizes.
  *
  * Assumes all array sizes fit the data (are according to block sizes)
+ *
+ * The options are found as a candidate set by findCands, and then written out in increasing order.
  */
 int findOptions(int *b,int index,int *options, int blockw, int blockh){
-	int i, count = 0, max = blockw*blockh;
-	for (i = 1 ; i<=max ; i++){
-		if (isValidm(b,(index/max),(index%max),i,blockw,blockh)){
-			options[count] = i;
-			count++;
-		}
+	int count, words = CAND_WORDS(blockw*blockh);
+	bitmask local[CAND_LOCAL_WORDS], *s = local;
+	if (words > CAND_LOCAL_WORDS){
+		assert((s = (bitmask*) malloc(words*sizeof(bitmask)))!=NULL && "Memory allocation error");
+	}
+	findCands(b, getGeometry(blockw, blockh), index, s);
+	count = candToArray(s, words, options);
+	if (s != local){
+		free(s);
 	}
 	return count;
 }
 
+/*
+ * Stores the valid assignments to cell (index) in candidate set s (of CAND_WORDS(dim) words, see candSet.h), and returns
+ * their number. The values of all peers are removed from the full set in a single pass over the cell's peers.
+ */
+int findCands(int* b, geometry* g, int index, bitmask* s){
+	int p, *peer = g->peers + index*g->numPeers;
+	candFill(s, g->dim);
+	for (p = 0 ; p < g->numPeers ; p++){
+		if (b[peer[p]] != 0){
+			candRemove(s, b[peer[p]]);
+		}
+	}
+	return candCount(s, CAND_WORDS(g->dim));
+}
+
 
 /*
  * Translates cell number x in block to general index in board.
@@ -160,67 +350,12 @@ int translateBlockIndex(int blockNum, int placeInBlock, int blockw, int blockh){
 	return (index + cols + (rows*dim)); /*index of desired cell is block's start index + number of cells in rows between them and col offset*/
 }
 
-/*
- * checks if placing val into (i,j) causes error in row.
- * Very similar to function in game module. The choice to duplicate here is because of subtle differences in requirements
- * between the two modules, and the choice to run all solver modules on an array instead of the board.
- * This path was chosen in order to avoid unwanted dependencies between the two modules.
- */
-int isValidRm(int* b, int i, int j, int val, int size){
-	int index = (i * size), k;
-	for (k = 0 ; k < size ; k++){
-		if ((b[index]==val) && (k!=j)){
-			return 0;
-		}
-		index++;
-	}
-	return 1;
-}
-
-/*
- * checks if placing val into (i,j) causes error in column
- */
-int isValidCm(int* b, int i, int j, int val, int size){
-		int index = j, k;
-		for (k = 0 ; k < size ; k++){
-			if ((b[index]==val) && (k!=i)){
-				return 0;
-			}
-			index += size;
-		}
-		return 1;
-	}
-
-/*
- * checks if placing val into (i,j) causes error in block
- */
-int isValidBm(int* b, int i, int j, int val, int blockW, int blockH){
-	int bi, bj, index , k, l, max = blockH*blockW, origI = i*max + j;
-	bi = i - (i % (blockH)); /*index of first row in block*/
-	bj = j - (j % (blockW)); /*index of first col in block*/
-	for (k = 0 ; k<(blockH); k++){
-		for (l = 0 ; l<(blockW) ; l++){
-			index = (bi + k)*max + bj + l;
-			if ((b[index]==val) && (index!=origI)){
-				return 0;
-			}
-		}
-	}
-	return 1;
-}
-
 /*
  * Returns 1 if the whole board is valid
  * 0 otherwise
  */
 int isAllValid(int* b, int blockW, int blockH){
-	int i, dim =blockW * blockH, size = dim*dim;
-	for (i=0; i<size ; i++){
-		if (!isValidm(b,i/dim,i%dim,b[i],blockW,blockH)){
-			return 0;
-		}
-	}
-	return 1;
+	return (findErrors(b, blockW, blockH, NULL) == 0);
 }
 
 /*
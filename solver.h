@@ -13,9 +13,13 @@
 #ifndef SOLVER_H_
 #define SOLVER_H_
 
+#include "bigNum.h"
+#include "geometry.h"
+#include "candSet.h"
+
 /*
  * Counts number of solutions possible for current board and Returns
- * number of different possible solutions for current board state (0 if none).
+ * number of different possible solutions for current board state (0 if none, -1 if the count doesn't fit in an int).
  *
  * Receives board in 1d array form and size parameters.
  * Assumes legal board size and matching block sizes.
@@ -26,6 +30,21 @@
  */
 int num_solutions(int* b, int blockW, int blockH);
 
+/*
+ * Same search as num_solutions, but adds the number of solutions found to count (which is wide enough not to overflow on
+ * near empty boards), and stops as soon as count reaches limit. Searches exhaustively if limit <= 0.
+ * The board is left as it was received, also when stopping early.
+ */
+void boundedSolutions(int* b, int blockW, int blockH, int limit, bigNum* count);
+
+/*
+ * Returns 1 if board b is solvable and fills it with a solution, returns 0 (and leaves b unchanged) otherwise.
+ * Uses the same search as num_solutions, stopping at the first solution.
+ * stop is either NULL, or a flag that makes the search give up once it's set (by another thread), in which case -1 is
+ * returned and b is left unchanged.
+ */
+int backtrackSolve(int* b, int blockW, int blockH, volatile int* stop);
+
 /*
  * Returns 1 if placing value val to cell (i+1,j+1) is valid. 0 otherwise.
  *
@@ -34,15 +53,21 @@ int num_solutions(int* b, int blockW, int blockH);
  */
 int isValidm(int* b, int i, int j, int val, int blockW, int blockH);
 
+/*
+ * Same as isValidm, for the cell in index, on a board of geometry g (see geometry.h).
+ * Used on hot paths, where the geometry is already at hand.
+ */
+int isValidAt(int* b, geometry* g, int index, int val);
+
 /*
  * Fills all obvious placements in board into b1, and returns number of cells filled.
  * Note that this function might result in an erroneous board (which means it's not solvable).
  *
- * Receives three int arrays: b1 representing a board, b2 with the same size, options- of at least maxVal size, and block sizes.
+ * Receives two int arrays: b1 representing a board, b2 with the same size, and block sizes.
  *
  * Assumes all non empty cells of b2 contain the same values as b1.
  */
-int autofill(int* b1, int* b2, int* options, int blockw, int blockh);
+int autofill(int* b1, int* b2, int blockw, int blockh);
 
 /*
  * Performs autofill moves on the board, until no obvious placements remain.
@@ -60,6 +85,12 @@ int fullAuto(int* b1, int blockw, int blockh);
  */
 int findOptions(int *b,int index,int *options, int blockw, int blockh);
 
+/*
+ * Stores the valid assignments to cell (index) in candidate set s (of CAND_WORDS(dim) words, see candSet.h), and returns
+ * their number. Receives array representing board, the board's geometry, cell index and the set to fill.
+ */
+int findCands(int* b, geometry* g, int index, bitmask* s);
+
 /*
  * Translates cell number x in block to general index in board.
  * The reference point is the top leftmost cell in block.
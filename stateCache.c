@@ -0,0 +1,142 @@
+/*
+ * stateCache.c
+ *
+ *	Cache of board states. See header.
+ *
+ *	The cache is small (tens of states), so it's a plain array searched from start to end, with the time of every
+ *	state's last use kept for the replacement (a search is nothing next to the solve it saves).
+ *
+ *  Created on: Jul 28, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "stateCache.h"
+#include "bitSolver.h"
+#include "settings.h"
+
+static stateEntry* entries = NULL; /*the cached states, allocated on first use*/
+static int numEntries = 0;
+static unsigned long tick = 0; /*time of the last use of any state*/
+
+/*
+ * Returns the hash word (word is 0 or 1) of value val in cell index. Value 0 (an empty cell) has the word 0.
+ * The word is a fixed function of the (cell, value) pair, so no table is kept, and the hash of a state is the same in
+ * every run. It's made by a multiplicative mixer, as the words of a shift / XOR generator XOR to each other and make
+ * different states collide.
+ */
+unsigned long cellHash(int index, int val, int word){
+	if (val == 0){
+		return 0;
+	}
+	return mix32(mix32(index) + 2*(unsigned long) val + word);
+}
+
+/*
+ * Returns what is known about state hash of a board with the given block sizes, or NULL if it isn't in the cache.
+ */
+stateEntry* cacheFind(unsigned long hash[2], int blockW, int blockH){
+	int i;
+	stateEntry* e;
+	for (i = 0 ; i < numEntries ; i++){
+		e = entries + i;
+		if (e->hash[0] == hash[0] && e->hash[1] == hash[1] && e->blockW == blockW && e->blockH == blockH){
+			tick++;
+			e->used = tick;
+			return e;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Same as cacheFind, but adds the state (with nothing known about it) if it isn't in the cache, in place of the least
+ * recently used state if the cache is full.
+ * Returns NULL only if the cache holds nothing.
+ */
+stateEntry* cacheAdd(unsigned long hash[2], int blockW, int blockH){
+	int i, cap = getSettings()->cacheSize;
+	stateEntry* e = cacheFind(hash, blockW, blockH);
+	if (e != NULL || cap == 0){
+		return e;
+	}
+	if (entries == NULL){
+		assert((entries = (stateEntry*) malloc(cap*sizeof(stateEntry)))!=NULL && "Memory allocation error");
+	}
+	if (numEntries < cap){
+		e = entries + numEntries;
+		numEntries++;
+	}
+	else{
+		e = entries;
+		for (i = 1 ; i < numEntries ; i++){
+			if (entries[i].used < e->used){
+				e = entries + i;
+			}
+		}
+		free(e->solution);
+	}
+	e->hash[0] = hash[0];
+	e->hash[1] = hash[1];
+	e->blockW = blockW;
+	e->blockH = blockH;
+	e->solvable = 0;
+	e->solution = NULL;
+	e->counted = 0;
+	e->limit = 0;
+	tick++;
+	e->used = tick;
+	return e;
+}
+
+/*
+ * Records whether the state of entry e is solvable (1) or not (-1), with one of it's solutions if solvable (solution is
+ * copied, size is the number of cells).
+ */
+void cacheSolved(stateEntry* e, int solvable, int* solution, int size){
+	assert((solvable == 1 || solvable == -1) && "Only definitive answers are cached");
+	e->solvable = solvable;
+	if (solvable == 1 && solution != NULL && e->solution == NULL){
+		assert((e->solution = (int*) malloc(size*sizeof(int)))!=NULL && "Memory allocation error");
+		memcpy(e->solution, solution, size*sizeof(int));
+	}
+}
+
+/*
+ * Records count as the number of solutions of the state of entry e, counted with limit (0 if none).
+ * Also records whether the state is solvable.
+ */
+void cacheCount(stateEntry* e, bigNum* count, int limit){
+	e->counted = 1;
+	e->count = *count;
+	e->limit = (limit > 0 && bigAtLeast(count, limit)) ? limit : 0; /*a count that stopped below it's limit is exact*/
+	e->solvable = bigAtLeast(count, 1) ? 1 : -1;
+}
+
+/*
+ * If the count of entry e answers a count with limit (0 if none), sets count to it and returns 1, otherwise returns 0.
+ * An exact count answers any count, and a count stopped at it's limit answers counts with a limit no larger.
+ */
+int cachedCount(stateEntry* e, int limit, bigNum* count){
+	if (!e->counted || (e->limit > 0 && (limit <= 0 || limit > e->limit))){
+		return 0;
+	}
+	*count = e->count;
+	return 1;
+}
+
+/*
+ * Frees all states held in the cache.
+ */
+void freeCache(void){
+	int i;
+	for (i = 0 ; i < numEntries ; i++){
+		free(entries[i].solution);
+	}
+	free(entries);
+	entries = NULL;
+	numEntries = 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * stateCache.h
+ *
+ *	Remembers what is known about recently seen board states (solvable or not, a solution, the number of solutions), so
+ *	a state that is seen again (after an undo, a redo, or setting a cell back to what it was) isn't solved again.
+ *
+ *	A state is keyed by a Zobrist hash of it's cells: every (cell, value) pair has two random words, and the hash of a
+ *	state is the XOR of the words of it's filled cells (empty cells add nothing). Changing a single cell toggles the
+ *	words of it's old and new values, so the board keeps it's hash up to date in O(1) (see game.h). The hash is two
+ *	words, so a wrong hit needs both of them to collide, and the block sizes are kept with every state as well.
+ *
+ *	The cache holds up to the number of states set in settings, and when full, replaces the least recently used one.
+ *	A cache of size 0 holds nothing (every lookup misses).
+ *
+ *  Created on: Jul 28, 2019
+ *      Author: Edanz
+ */
+
+#ifndef STATECACHE_H_
+#define STATECACHE_H_
+
+#include "bigNum.h"
+
+typedef struct S_stateEntry{
+	unsigned long hash[2];
+	int blockW;
+	int blockH;
+	int solvable; /*1 if the state is solvable, -1 if not, 0 if unknown*/
+	int* solution; /*a solution of the state (board size array), or NULL if none is known*/
+	int counted; /*1 if count holds a count of the state's solutions*/
+	bigNum count;
+	int limit; /*the limit count was made with (0 if none)*/
+	unsigned long used; /*time of last use*/
+} stateEntry;
+
+/*
+ * Returns the hash word (word is 0 or 1) of value val in cell index. Value 0 (an empty cell) has the word 0.
+ */
+unsigned long cellHash(int index, int val, int word);
+
+/*
+ * Returns what is known about state hash of a board with the given block sizes, or NULL if it isn't in the cache.
+ */
+stateEntry* cacheFind(unsigned long hash[2], int blockW, int blockH);
+
+/*
+ * Same as cacheFind, but adds the state (with nothing known about it) if it isn't in the cache.
+ * Returns NULL only if the cache holds nothing.
+ */
+stateEntry* cacheAdd(unsigned long hash[2], int blockW, int blockH);
+
+/*
+ * Records whether the state of entry e is solvable (1) or not (-1), with one of it's solutions if solvable (solution is
+ * copied, size is the number of cells).
+ * Only definitive answers may be recorded: a solution, or a proof there is none. The answer of a failed or stopped
+ * engine isn't, as the state comes back after set / undo / redo, and the wrong answer would come back with it until the
+ * entry is evicted (the disk cache doesn't store unsolvable states for the same reason, see diskCache.h).
+ */
+void cacheSolved(stateEntry* e, int solvable, int* solution, int size);
+
+/*
+ * Records count as the number of solutions of the state of entry e, counted with limit (0 if none).
+ */
+void cacheCount(stateEntry* e, bigNum* count, int limit);
+
+/*
+ * If the count of entry e answers a count with limit (0 if none), sets count to it and returns 1, otherwise returns 0.
+ */
+int cachedCount(stateEntry* e, int limit, bigNum* count);
+
+/*
+ * Frees all states held in the cache.
+ */
+void freeCache(void);
+
+#endif /* STATECACHE_H_ */
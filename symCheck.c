@@ -0,0 +1,103 @@
+/*
+ * symCheck.c
+ *
+ *	Checks the symmetry reduced counts of the symmetry module against plain counts, for every block layout of up to
+ *	CHECK_MAX_DIM values. Built and run by "make check": prints every board whose counts differ and exits with 1 if any
+ *	did.
+ *
+ *	The boards checked for every layout are the empty board and boards with a few filled cells, copied from a fixed
+ *	solution at random places (with a fixed seed, so every run checks the same boards). Boards whose plain count reaches
+ *	CHECK_LIMIT are skipped, they take too long to count without the symmetries.
+ *
+ *  Created on: Jul 30, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "symmetry.h"
+#include "bitSolver.h"
+#include "bigNum.h"
+
+#define CHECK_MAX_DIM 6 /*largest number of values of the layouts checked*/
+#define CHECK_LIMIT 2000000 /*plain counts stop here*/
+#define CHECK_BOARDS 4 /*boards with filled cells checked for every number of filled cells*/
+
+void plainCount(int* b, int blockW, int blockH, int limit, bigNum* count);
+int checkBoard(int* b, int blockW, int blockH, int* skipped);
+
+/*
+ * Checks all layouts, see above.
+ */
+int main(void){
+	int blockW, blockH, dim, i, k, r, c, n, checked = 0, skipped = 0, failed = 0, *b;
+	srand(1);
+	for (dim = 1 ; dim <= CHECK_MAX_DIM ; dim++){
+		for (blockW = 1 ; blockW <= dim ; blockW++){
+			if (dim % blockW != 0){
+				continue;
+			}
+			blockH = dim/blockW;
+			assert((b = (int*) malloc(dim*dim*sizeof(int)))!=NULL && "Memory allocation error");
+			for (n = 0 ; n <= 2*dim ; n = (n < 3) ? n + 1 : 2*n){
+				for (k = 0 ; k < ((n == 0) ? 1 : CHECK_BOARDS) ; k++){
+					memset(b, 0, dim*dim*sizeof(int));
+					for (i = 0 ; i < n ; i++){ /*a cell of the solution shifting rows by blockW in a band and bands by 1*/
+						r = rand()%dim;
+						c = rand()%dim;
+						b[r*dim + c] = (blockW*(r%blockH) + r/blockH + c)%dim + 1;
+					}
+					failed += !checkBoard(b, blockW, blockH, &skipped);
+					checked++;
+				}
+			}
+			free(b);
+			printf("%dx%d checked\n", blockW, blockH);
+			fflush(stdout);
+		}
+	}
+	printf("symmetry check: %d boards, %d skipped, %d failed\n", checked, skipped, failed);
+	return failed ? 1 : 0;
+}
+
+/*
+ * Counts board b with and without the symmetries and returns whether the counts agree (prints the board if they don't).
+ * Increments *skipped (and returns 1) if the plain count reaches CHECK_LIMIT.
+ */
+int checkBoard(int* b, int blockW, int blockH, int* skipped){
+	int dim = blockW*blockH, i;
+	int* copy;
+	bigNum plain, reduced;
+	char plainStr[BIG_STR_LEN], reducedStr[BIG_STR_LEN];
+	assert((copy = (int*) malloc(dim*dim*sizeof(int)))!=NULL && "Memory allocation error");
+	memcpy(copy, b, dim*dim*sizeof(int));
+	bigSet(&plain, 0);
+	plainCount(copy, blockW, blockH, CHECK_LIMIT, &plain);
+	free(copy);
+	if (bigAtLeast(&plain, CHECK_LIMIT)){
+		(*skipped)++;
+		return 1;
+	}
+	bigSet(&reduced, 0);
+	symCount(b, blockW, blockH, &reduced, plainCount);
+	bigToString(&plain, plainStr);
+	bigToString(&reduced, reducedStr);
+	if (strcmp(plainStr, reducedStr) == 0){
+		return 1;
+	}
+	printf("%dx%d board counted %s with symmetries, %s without:", blockW, blockH, reducedStr, plainStr);
+	for (i = 0 ; i < dim*dim ; i++){
+		printf("%s%d", (i%dim == 0) ? "\n\t" : " ", b[i]);
+	}
+	printf("\n");
+	return 0;
+}
+
+/*
+ * Adds the number of solutions of b to count with the bitmask counter and no heuristics, stopping at limit (if positive).
+ */
+void plainCount(int* b, int blockW, int blockH, int limit, bigNum* count){
+	bitCountLimit(b, blockW, blockH, 0, NULL, limit, count);
+}
@@ -0,0 +1,263 @@
+/*
+ * symmetry.c
+ *
+ *	Symmetry reduced counting, see header for the general idea.
+ *
+ *	The digit symmetry is removed first, by filling a block: the block missing the fewest values that do appear on the
+ *	board (at most SYM_MAX_EXTRA of them) is chosen, those values are tried in all valid arrangements in it's empty
+ *	cells, and the cells left get the values missing from the board in increasing order.
+ *	Every board filled this way has all values on it, and only row and column symmetries are left. Those are removed by
+ *	filling "slots": cells that must hold a larger value than the slot before them (if it has one). Rows are permuted
+ *	with the values of column c0 (the first column with a filled cell, which no column permutation moves), columns with
+ *	the values of row r0.
+ *
+ *  Created on: Jul 26, 2019
+ *      Author: Edanz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "symmetry.h"
+#include "solver.h"
+#include "geometry.h"
+#include "settings.h"
+
+#define SYM_MAX_EXTRA 2 /*most values that appear on the board but are missing from the block filled for the digit symmetry*/
+
+typedef struct S_symSearch{
+	int* b; /*board being filled*/
+	int* scratch; /*copy of b handed to the counter, which might change it*/
+	geometry* g;
+	int* slots; /*cells filled to break the row and column symmetries*/
+	int* prev; /*prev[i] is the slot that slots[i] must be larger than, or -1*/
+	int numSlots;
+	int* facts; /*the number of permutations the slots break is the product of the factorials of these*/
+	int numFacts;
+	countFunc sub;
+	int leaves; /*number of sub boards counted*/
+} symSearch;
+
+void placeExtra(symSearch* s, int* cells, int numCells, int* extra, int numExtra, int* missing, int numMissing, int i, bigNum* out);
+void countGeometric(symSearch* s, bigNum* out);
+void addSlots(symSearch* s, int fixedLine, int isRow);
+void fillSlots(symSearch* s, int i, bigNum* out);
+void bigMulFact(bigNum* n, int k);
+
+/*
+ * Counts the solutions of board b with the symmetry reductions (see header).
+ */
+void symCount(int* b, int blockW, int blockH, bigNum* count, countFunc sub){
+	symSearch s;
+	geometry* g = getGeometry(blockW, blockH);
+	int dim = g->dim, i, v, k, best = -1, bestExtra = SYM_MAX_EXTRA + 1, numExtra = 0, numCells = 0, numMissing = 0;
+	int *used, *inBlock, *cells, *extra, *missing;
+	bigNum total;
+	assert((s.b = (int*) malloc(2*g->size*sizeof(int)))!=NULL && "Memory allocation error");
+	s.scratch = s.b + g->size;
+	memcpy(s.b, b, g->size*sizeof(int));
+	/*slots and prev (a slot per row and column at most), and facts (a factorial per band and stack, and one more each)*/
+	assert((s.slots = (int*) malloc((4*dim + blockW + blockH + 2)*sizeof(int)))!=NULL && "Memory allocation error");
+	s.prev = s.slots + 2*dim;
+	s.facts = s.prev + 2*dim;
+	s.g = g;
+	s.sub = sub;
+	s.leaves = 0;
+	assert((used = (int*) calloc(5*dim + 1, sizeof(int)))!=NULL && "Memory allocation error");
+	inBlock = used + dim + 1;
+	cells = inBlock + dim;
+	extra = cells + dim;
+	missing = extra + dim;
+	for (i = 0 ; i < g->size ; i++){
+		used[b[i]] = 1;
+	}
+	for (v = 1 ; v <= dim ; v++){
+		if (!used[v]){
+			missing[numMissing] = v;
+			numMissing++;
+		}
+	}
+	for (k = 0 ; k < dim && numMissing >= 2 ; k++){ /*block missing the fewest values that appear on the board*/
+		memset(inBlock, 0, dim*sizeof(int));
+		for (i = 0 ; i < dim ; i++){
+			if (b[g->units[(2*dim + k)*dim + i]] != 0){
+				inBlock[b[g->units[(2*dim + k)*dim + i]] - 1] = 1;
+			}
+		}
+		for (v = 1, i = 0 ; v <= dim ; v++){
+			i += (used[v] && !inBlock[v - 1]);
+		}
+		if (i < bestExtra){
+			best = k;
+			bestExtra = i;
+			for (v = 1, numExtra = 0 ; v <= dim ; v++){
+				if (used[v] && !inBlock[v - 1]){
+					extra[numExtra] = v;
+					numExtra++;
+				}
+			}
+		}
+	}
+	bigSet(&total, 0);
+	if (best >= 0){
+		for (i = 0 ; i < dim ; i++){
+			if (b[g->units[(2*dim + best)*dim + i]] == 0){
+				cells[numCells] = g->units[(2*dim + best)*dim + i];
+				numCells++;
+			}
+		}
+		placeExtra(&s, cells, numCells, extra, numExtra, missing, numMissing, 0, &total);
+		bigMulFact(&total, numMissing);
+	}
+	else{
+		countGeometric(&s, &total);
+	}
+	if (getSettings()->stats){
+		printf("symmetry: %d sub boards counted\n", s.leaves);
+	}
+	bigAdd(count, &total);
+	free(used);
+	free(s.slots);
+	free(s.b);
+}
+
+/*
+ * Places extra[i..] in all valid ways in the empty cells of the block chosen for the digit symmetry, and once all are
+ * placed, fills the cells left with the values missing from the board in increasing order and counts the board.
+ */
+void placeExtra(symSearch* s, int* cells, int numCells, int* extra, int numExtra, int* missing, int numMissing, int i, bigNum* out){
+	int c, j;
+	if (i == numExtra){
+		for (c = 0, j = 0 ; c < numCells ; c++){
+			if (s->b[cells[c]] == 0){
+				s->b[cells[c]] = missing[j]; /*never invalid, these values appear nowhere else*/
+				j++;
+			}
+		}
+		countGeometric(s, out);
+		for (c = 0 ; c < numCells ; c++){
+			for (j = 0 ; j < numMissing ; j++){
+				if (s->b[cells[c]] == missing[j]){
+					s->b[cells[c]] = 0;
+				}
+			}
+		}
+		return;
+	}
+	for (c = 0 ; c < numCells ; c++){
+		if (s->b[cells[c]] == 0 && isValidAt(s->b, s->g, cells[c], extra[i])){
+			s->b[cells[c]] = extra[i];
+			placeExtra(s, cells, numCells, extra, numExtra, missing, numMissing, i + 1, out);
+			s->b[cells[c]] = 0;
+		}
+	}
+}
+
+/*
+ * Adds the number of solutions of s->b to out, breaking the row and column symmetries left in it.
+ * Only counts the board if it has no filled cells (there is no line to order the others by).
+ */
+void countGeometric(symSearch* s, bigNum* out){
+	geometry* g = s->g;
+	int i, r0 = -1, c0 = -1;
+	bigNum sum;
+	for (i = 0 ; i < g->size ; i++){ /*first row and first column with a filled cell*/
+		if (s->b[i] != 0){
+			if (r0 < 0){
+				r0 = g->rowOf[i];
+			}
+			if (c0 < 0 || g->colOf[i] < c0){
+				c0 = g->colOf[i];
+			}
+		}
+	}
+	s->numSlots = 0;
+	s->numFacts = 0;
+	if (r0 >= 0){
+		addSlots(s, c0, 1);
+		addSlots(s, r0, 0);
+	}
+	bigSet(&sum, 0);
+	fillSlots(s, 0, &sum);
+	for (i = 0 ; i < s->numFacts ; i++){
+		bigMulFact(&sum, s->facts[i]);
+	}
+	bigAdd(out, &sum);
+}
+
+/*
+ * Adds the slots breaking the row symmetries (isRow = 1, the slots are in column fixedLine) or the column symmetries
+ * (isRow = 0, in row fixedLine), and records the factorials making up the number of permutations they break.
+ */
+void addSlots(symSearch* s, int fixedLine, int isRow){
+	geometry* g = s->g;
+	int dim = g->dim, per = isRow ? g->blockH : g->blockW, grp, j, k, line, cell, empty, first, prevSlot;
+	int emptyGroups = 0, lastGroupHead = -1;
+	for (grp = 0 ; grp < dim/per ; grp++){
+		first = -1;
+		prevSlot = -1;
+		empty = 0;
+		for (j = 0 ; j < per ; j++){
+			line = grp*per + j;
+			for (k = 0 ; k < dim ; k++){ /*is the line empty?*/
+				cell = isRow ? line*dim + k : k*dim + line;
+				if (s->b[cell] != 0){
+					break;
+				}
+			}
+			if (k < dim){
+				continue;
+			}
+			s->slots[s->numSlots] = isRow ? line*dim + fixedLine : fixedLine*dim + line;
+			s->prev[s->numSlots] = prevSlot;
+			if (first < 0){
+				first = s->numSlots;
+			}
+			prevSlot = s->numSlots;
+			s->numSlots++;
+			empty++;
+		}
+		s->facts[s->numFacts] = empty;
+		s->numFacts++;
+		if (empty == per){ /*whole band (stack) is empty, bands are ordered by their first slot*/
+			s->prev[first] = lastGroupHead;
+			lastGroupHead = first;
+			emptyGroups++;
+		}
+	}
+	s->facts[s->numFacts] = emptyGroups;
+	s->numFacts++;
+}
+
+/*
+ * Fills slots i.. in all valid ways that keep every slot larger than it's prev, and counts every board filled this way.
+ */
+void fillSlots(symSearch* s, int i, bigNum* out){
+	int v, low, cell;
+	if (i == s->numSlots){
+		memcpy(s->scratch, s->b, s->g->size*sizeof(int));
+		s->sub(s->scratch, s->g->blockW, s->g->blockH, 0, out);
+		s->leaves++;
+		return;
+	}
+	cell = s->slots[i];
+	low = (s->prev[i] >= 0) ? s->b[s->slots[s->prev[i]]] + 1 : 1;
+	for (v = low ; v <= s->g->dim ; v++){
+		if (isValidAt(s->b, s->g, cell, v)){
+			s->b[cell] = v;
+			fillSlots(s, i + 1, out);
+			s->b[cell] = 0;
+		}
+	}
+}
+
+/*
+ * Multiplies n by k!.
+ */
+void bigMulFact(bigNum* n, int k){
+	int i;
+	for (i = 2 ; i <= k ; i++){
+		bigMul(n, i);
+	}
+}
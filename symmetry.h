@@ -0,0 +1,35 @@
+/*
+ * symmetry.h
+ *
+ *	Counts solutions of sparse boards by counting only one solution out of every group of solutions that the symmetries
+ *	left unbroken by the filled cells map onto each other, and multiplying by the size of the group.
+ *
+ *	Two kinds of symmetries are used, each one only where the filled cells don't break it:
+ *		- digit relabeling: values that appear nowhere on the board can be swapped with each other in any solution.
+ *		- row and column permutations: rows of a band with no filled cells can be swapped with each other, and so can whole
+ *		  bands with no filled cells (and the same for columns and stacks).
+ *	No permutation of either kind (other than the identity) leaves a solution unchanged, so every group of solutions
+ *	mapped onto each other has exactly as many solutions as the group has permutations, and the count is exact.
+ *
+ *	The counted solutions are those in a canonical form: for the digits, the missing values are placed in increasing order
+ *	in the empty cells of a block, and for the rows, the values in a column that has filled cells are increasing down every
+ *	band and between empty bands (same for columns, along a row that has filled cells). The canonical cells are filled
+ *	by trying all the ways to do so, and every sub board created this way is counted by a regular counter.
+ *
+ *  Created on: Jul 26, 2019
+ *      Author: Edanz
+ */
+
+#ifndef SYMMETRY_H_
+#define SYMMETRY_H_
+
+#include "bigNum.h"
+#include "parallel.h"
+
+/*
+ * Adds the number of solutions of board b to count, counting every canonical sub board with sub (with no limit).
+ * Receives the board in 1d array form (not modified), block sizes and the counter. Assumes the board is valid.
+ */
+void symCount(int* b, int blockW, int blockH, bigNum* count, countFunc sub);
+
+#endif /* SYMMETRY_H_ */